@@ -0,0 +1,608 @@
+// Image decode throughput, stb_image against the optional decoder backends
+// found at configure time (libjpeg-turbo for JPEG, libspng for PNG).
+//
+//     learn_opengl_bench_images [--iterations n] [--threads n] [--backend name]
+//                               [path...]
+//
+// Decodes every JPEG, PNG and HDR file under the given files and directories
+// (default `assets`) `iterations` times (default 8) with each backend, once
+// on one thread and once on `threads` threads (default every hardware
+// thread). Every backend, format and thread count gets a row with the input
+// and output MB/s, the per-image latency percentiles and the peak resident
+// set size of the run, so the fastest decoder can be picked per format.
+// Every backend decodes JPEG and PNG to RGBA8, the layout the texture
+// loader uploads, so output MB/s compares like with like. `--backend`
+// limits the runs to one backend.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "stb_image.h"
+
+#if defined(HAVE_TURBOJPEG)
+#include <turbojpeg.h>
+#endif
+
+#if defined(HAVE_SPNG)
+#include <spng.h>
+#endif
+
+#include <mapped_file.h>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+double elapsed_ms(clock_type::time_point start) {
+    return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+double megabytes_per_second(std::size_t bytes, double milliseconds) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0) / (milliseconds / 1000.0);
+}
+
+enum class image_format {
+    jpeg,
+    png,
+    hdr,
+    other,
+};
+
+constexpr image_format corpus_formats[] = {
+    image_format::jpeg,
+    image_format::png,
+    image_format::hdr,
+};
+
+char const *format_name(image_format format) {
+    switch (format) {
+        case image_format::jpeg:
+            return "jpeg";
+        case image_format::png:
+            return "png";
+        case image_format::hdr:
+            return "hdr";
+        default:
+            return "other";
+    }
+}
+
+// from the signature rather than the extension
+image_format detect_format(unsigned char const *data, std::size_t size) {
+    auto const starts_with = [&](std::string_view magic) {
+        if (size < magic.size()) {
+            return false;
+        }
+
+        for (std::size_t i = 0; i < magic.size(); ++i) {
+            if (data[i] != static_cast<unsigned char>(magic[i])) {
+                return false;
+            }
+        }
+
+        return true;
+    };
+
+    if (starts_with("\xFF\xD8\xFF")) {
+        return image_format::jpeg;
+    }
+
+    if (starts_with("\x89PNG\r\n\x1A\n")) {
+        return image_format::png;
+    }
+
+    if (starts_with("#?RADIANCE") || starts_with("#?RGBE")) {
+        return image_format::hdr;
+    }
+
+    return image_format::other;
+}
+
+// One decoder library behind the benchmark. Every worker thread creates its
+// own instance, so a backend can keep handles and output buffers between
+// images without locking. Adding a backend is a subclass and an entry in
+// `available_backends`.
+class ImageDecoder {
+public:
+    virtual ~ImageDecoder() = default;
+
+    virtual bool supports(image_format format) const = 0;
+
+    // decode `size` bytes to RGBA8 texels, or RGB floats for HDR, and return
+    // the size of the decoded image in bytes, 0 if it failed
+    virtual std::size_t decode(unsigned char const *data, std::size_t size) = 0;
+};
+
+class StbDecoder final : public ImageDecoder {
+public:
+    bool supports(image_format) const override { return true; }
+
+    std::size_t decode(unsigned char const *data, std::size_t size) override {
+        auto const length = static_cast<int>(size);
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+
+        if (stbi_is_hdr_from_memory(data, length)) {
+            auto *texels =
+                stbi_loadf_from_memory(data, length, &width, &height, &channels, 3);
+
+            if (texels == nullptr) {
+                return 0;
+            }
+
+            stbi_image_free(texels);
+            return static_cast<std::size_t>(width) * height * 3 * sizeof(float);
+        }
+
+        auto *texels = stbi_load_from_memory(data, length, &width, &height, &channels, 4);
+
+        if (texels == nullptr) {
+            return 0;
+        }
+
+        stbi_image_free(texels);
+        return static_cast<std::size_t>(width) * height * 4;
+    }
+};
+
+#if defined(HAVE_TURBOJPEG)
+class TurboJpegDecoder final : public ImageDecoder {
+public:
+    TurboJpegDecoder() : handle(tjInitDecompress()) {}
+
+    ~TurboJpegDecoder() override {
+        if (handle != nullptr) {
+            tjDestroy(handle);
+        }
+    }
+
+    TurboJpegDecoder(TurboJpegDecoder const&) = delete;
+    TurboJpegDecoder& operator=(TurboJpegDecoder const&) = delete;
+
+    bool supports(image_format format) const override {
+        return format == image_format::jpeg;
+    }
+
+    std::size_t decode(unsigned char const *data, std::size_t size) override {
+        auto const length = static_cast<unsigned long>(size);
+        int width = 0;
+        int height = 0;
+        int subsampling = 0;
+        int colourspace = 0;
+
+        if (handle == nullptr
+            || tjDecompressHeader3(
+                   handle,
+                   data,
+                   length,
+                   &width,
+                   &height,
+                   &subsampling,
+                   &colourspace
+               ) != 0) {
+            return 0;
+        }
+
+        texels.resize(static_cast<std::size_t>(width) * height * 4);
+
+        // warnings about corrupt but decodable data still produce an image
+        auto *output = texels.data();
+        auto const status =
+            tjDecompress2(handle, data, length, output, width, 0, height, TJPF_RGBA, 0);
+
+        if (status != 0 && tjGetErrorCode(handle) == TJERR_FATAL) {
+            return 0;
+        }
+
+        return texels.size();
+    }
+
+private:
+    tjhandle handle;
+    std::vector<unsigned char> texels;
+};
+#endif
+
+#if defined(HAVE_SPNG)
+class SpngDecoder final : public ImageDecoder {
+public:
+    bool supports(image_format format) const override {
+        return format == image_format::png;
+    }
+
+    std::size_t decode(unsigned char const *data, std::size_t size) override {
+        // a context decodes a single image
+        auto *context = spng_ctx_new(0);
+        std::size_t bytes = 0;
+
+        if (context == nullptr) {
+            return 0;
+        }
+
+        if (spng_set_png_buffer(context, data, size) != 0
+            || spng_decoded_image_size(context, SPNG_FMT_RGBA8, &bytes) != 0) {
+            bytes = 0;
+        } else {
+            texels.resize(bytes);
+
+            if (spng_decode_image(
+                    context,
+                    texels.data(),
+                    bytes,
+                    SPNG_FMT_RGBA8,
+                    SPNG_DECODE_TRNS
+                )
+                != 0) {
+                bytes = 0;
+            }
+        }
+
+        spng_ctx_free(context);
+        return bytes;
+    }
+
+private:
+    std::vector<unsigned char> texels;
+};
+#endif
+
+struct decoder_backend {
+    char const *name;
+    std::function<std::unique_ptr<ImageDecoder>()> create;
+};
+
+std::vector<decoder_backend> available_backends() {
+    auto backends = std::vector<decoder_backend>{
+        {"stb_image", [] { return std::make_unique<StbDecoder>(); }},
+    };
+
+#if defined(HAVE_TURBOJPEG)
+    backends.push_back({"libjpeg-turbo", [] {
+                            return std::make_unique<TurboJpegDecoder>();
+                        }});
+#endif
+
+#if defined(HAVE_SPNG)
+    backends.push_back({"spng", [] { return std::make_unique<SpngDecoder>(); }});
+#endif
+
+    return backends;
+}
+
+struct corpus_image {
+    std::filesystem::path path;
+    image_format format;
+    MappedFile file;
+};
+
+void add_image(std::filesystem::path const& path, std::vector<corpus_image>& corpus) {
+    auto file = MappedFile(path);
+
+    if (!file.ok()) {
+        std::cerr << "ERROR::BENCH::FILE_NOT_READ\n" << path.string() << "\n";
+        return;
+    }
+
+    // stb_image takes the length as an int
+    if (file.size() > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        std::cerr << "ERROR::BENCH::FILE_TOO_LARGE\n" << path.string() << "\n";
+        return;
+    }
+
+    auto const format = detect_format(file.data(), file.size());
+
+    if (format != image_format::other) {
+        corpus.push_back({path, format, std::move(file)});
+    }
+}
+
+void collect_images(
+    std::filesystem::path const& path,
+    std::vector<corpus_image>& corpus
+) {
+    auto error = std::error_code{};
+
+    if (!std::filesystem::is_directory(path, error)) {
+        add_image(path, corpus);
+        return;
+    }
+
+    auto files = std::vector<std::filesystem::path>{};
+
+    for (auto const& entry : std::filesystem::recursive_directory_iterator(path, error)) {
+        if (entry.is_regular_file(error)) {
+            files.push_back(entry.path());
+        }
+    }
+
+    // keep runs comparable between machines
+    std::sort(files.begin(), files.end());
+
+    for (auto const& file : files) {
+        add_image(file, corpus);
+    }
+}
+
+// Linux keeps a high water mark of the resident set that can be reset
+// between runs, elsewhere the peak covers the whole process
+void reset_peak_rss() {
+#if defined(__linux__)
+    std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+double peak_rss_mb() {
+#if defined(__linux__)
+    auto status = std::ifstream("/proc/self/status");
+    auto line = std::string{};
+
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return std::strtod(line.c_str() + 6, nullptr) / 1024.0;
+        }
+    }
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+    auto usage = rusage{};
+    getrusage(RUSAGE_SELF, &usage);
+
+#if defined(__APPLE__)
+    return static_cast<double>(usage.ru_maxrss) / (1024.0 * 1024.0);
+#else
+    return static_cast<double>(usage.ru_maxrss) / 1024.0;
+#endif
+#else
+    return 0.0;
+#endif
+}
+
+struct run_result {
+    double wall_ms = 0.0;
+    std::size_t input_bytes = 0;
+    std::size_t output_bytes = 0;
+    std::size_t failures = 0;
+    // milliseconds per decoded image, sorted
+    std::vector<double> latencies;
+    double peak_rss = 0.0;
+};
+
+// decode every image `iterations` times spread over `threads` workers,
+// which take the next image from a shared counter
+run_result run(
+    decoder_backend const& backend,
+    std::vector<corpus_image const *> const& images,
+    int iterations,
+    unsigned int threads
+) {
+    struct worker_result {
+        std::size_t input_bytes = 0;
+        std::size_t output_bytes = 0;
+        std::size_t failures = 0;
+        std::vector<double> latencies;
+    };
+
+    auto const jobs = images.size() * static_cast<std::size_t>(iterations);
+    auto next = std::atomic<std::size_t>{0};
+    auto results = std::vector<worker_result>(threads);
+    auto workers = std::vector<std::thread>{};
+
+    reset_peak_rss();
+    auto const start = clock_type::now();
+
+    for (unsigned int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            auto decoder = backend.create();
+            auto& result = results[t];
+
+            for (auto job = next++; job < jobs; job = next++) {
+                auto const& image = *images[job % images.size()];
+                auto const image_start = clock_type::now();
+                auto const bytes = decoder->decode(image.file.data(), image.file.size());
+
+                result.latencies.push_back(elapsed_ms(image_start));
+                result.input_bytes += image.file.size();
+                result.output_bytes += bytes;
+                result.failures += bytes == 0;
+            }
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    auto total = run_result{};
+    total.wall_ms = elapsed_ms(start);
+    total.peak_rss = peak_rss_mb();
+
+    for (auto const& result : results) {
+        total.input_bytes += result.input_bytes;
+        total.output_bytes += result.output_bytes;
+        total.failures += result.failures;
+        total.latencies.insert(
+            total.latencies.end(),
+            result.latencies.begin(),
+            result.latencies.end()
+        );
+    }
+
+    std::sort(total.latencies.begin(), total.latencies.end());
+    return total;
+}
+
+// nearest rank percentile of sorted values
+double percentile(std::vector<double> const& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+
+    auto const last = static_cast<double>(sorted.size() - 1);
+    return sorted[static_cast<std::size_t>(p * last + 0.5)];
+}
+
+void report(
+    char const *backend,
+    image_format format,
+    unsigned int threads,
+    run_result const& result
+) {
+    auto const input = megabytes_per_second(result.input_bytes, result.wall_ms);
+    auto const output = megabytes_per_second(result.output_bytes, result.wall_ms);
+
+    std::cout << std::left << std::setw(16) << backend << std::setw(6)
+              << format_name(format) << std::right << std::setw(4) << threads
+              << std::fixed << std::setprecision(1) << std::setw(10) << input
+              << std::setw(10) << output << std::setprecision(2) << std::setw(9)
+              << percentile(result.latencies, 0.5) << std::setw(9)
+              << percentile(result.latencies, 0.9) << std::setw(9)
+              << percentile(result.latencies, 0.99) << std::setprecision(1)
+              << std::setw(10) << result.peak_rss;
+
+    if (result.failures > 0) {
+        std::cout << "  (" << result.failures << " failed)";
+    }
+
+    std::cout << "\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    auto iterations = 8;
+    auto threads = std::max(std::thread::hardware_concurrency(), 1u);
+    auto only = std::string_view{};
+    auto paths = std::vector<std::filesystem::path>{};
+
+    for (int i = 1; i < argc; ++i) {
+        auto const arg = std::string_view{argv[i]};
+
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max(std::atoi(argv[++i]), 1);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = static_cast<unsigned int>(std::max(std::atoi(argv[++i]), 1));
+        } else if (arg == "--backend" && i + 1 < argc) {
+            only = argv[++i];
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+
+    auto backends = available_backends();
+
+    if (!only.empty()) {
+        std::erase_if(backends, [&](decoder_backend const& backend) {
+            return only != backend.name;
+        });
+    }
+
+    if (backends.empty()) {
+        std::cerr << "Unknown backend " << only << ", available:";
+
+        for (auto const& backend : available_backends()) {
+            std::cerr << " " << backend.name;
+        }
+
+        std::cerr << "\n";
+        return 1;
+    }
+
+    if (paths.empty()) {
+        paths.push_back("assets");
+    }
+
+    auto corpus = std::vector<corpus_image>{};
+
+    for (auto const& path : paths) {
+        collect_images(path, corpus);
+    }
+
+    if (corpus.empty()) {
+        std::cerr << "No JPEG, PNG or HDR images found.\n"
+                  << "usage: learn_opengl_bench_images [--iterations n] [--threads n] "
+                     "[--backend name] [path...]\n";
+        return 1;
+    }
+
+    std::cout << "corpus: " << corpus.size() << " images, " << iterations
+              << " iterations, " << threads << " threads\n";
+
+    for (auto const& image : corpus) {
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        stbi_info_from_memory(
+            image.file.data(),
+            static_cast<int>(image.file.size()),
+            &width,
+            &height,
+            &channels
+        );
+
+        std::cout << "  " << image.path.string() << ": " << format_name(image.format)
+                  << " " << width << "x" << height << "x" << channels << ", "
+                  << image.file.size() / 1024 << " KB\n";
+    }
+
+    // the peaks below also count the pages of the mapped corpus a run reads
+    std::cout << "baseline RSS: " << std::fixed << std::setprecision(1) << peak_rss_mb()
+              << " MB\n\n"
+              << std::left << std::setw(16) << "backend" << std::setw(6) << "format"
+              << std::right << std::setw(4) << "thr" << std::setw(10) << "in MB/s"
+              << std::setw(10) << "out MB/s" << std::setw(9) << "p50 ms" << std::setw(9)
+              << "p90 ms" << std::setw(9) << "p99 ms" << std::setw(10) << "peak MB"
+              << "\n";
+
+    auto const thread_counts = threads > 1 ? std::vector<unsigned int>{1, threads}
+                                           : std::vector<unsigned int>{1};
+
+    for (auto const& backend : backends) {
+        auto const decoder = backend.create();
+
+        for (auto const format : corpus_formats) {
+            auto images = std::vector<corpus_image const *>{};
+
+            for (auto const& image : corpus) {
+                if (image.format == format && decoder->supports(format)) {
+                    images.push_back(&image);
+                }
+            }
+
+            if (images.empty()) {
+                continue;
+            }
+
+            // one untimed pass faults the files in and warms the decoder
+            for (auto const *image : images) {
+                decoder->decode(image->file.data(), image->file.size());
+            }
+
+            for (auto const count : thread_counts) {
+                auto const result = run(backend, images, iterations, count);
+                report(backend.name, format, count, result);
+            }
+        }
+    }
+
+    return 0;
+}
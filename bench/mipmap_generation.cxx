@@ -0,0 +1,153 @@
+// Mip chain generation, glGenerateMipmap against the CPU filters in
+// mipmap.h followed by an upload of every level.
+//
+//     learn_opengl_bench_mipmaps [size] [iterations]
+//
+// Builds the chain of a `size` x `size` RGBA8 image (default 2048)
+// `iterations` times (default 8) with each method and reports the average
+// milliseconds including a final glFinish. CPU rows also show the time
+// spent filtering alone, once on one thread and once on every thread.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// clang-format off
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+// clang-format on
+
+#include <gl_ext.h>
+#include <mipmap.h>
+#include <texture.h>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+double elapsed_ms(clock_type::time_point start) {
+    return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+void report(char const *name, double total_ms, double filter_ms, int iterations) {
+    std::cout << std::left << std::setw(28) << name << std::right << std::fixed
+              << std::setprecision(2) << std::setw(10) << total_ms / iterations << " ms";
+
+    if (filter_ms > 0.0) {
+        std::cout << "  (filter " << filter_ms / iterations << " ms)";
+    }
+
+    std::cout << "\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int const size = argc > 1 ? std::atoi(argv[1]) : 2048;
+    int const iterations = argc > 2 ? std::atoi(argv[2]) : 8;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "bench", NULL, NULL);
+
+    if (window == NULL) {
+        std::cerr << "Failed to create GLFW window.\n";
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD.\n";
+        glfwTerminate();
+        return -1;
+    }
+
+    load_gl_extensions((GLADloadproc)glfwGetProcAddress);
+
+    auto const bytes = static_cast<std::size_t>(size) * size * 4;
+    auto pixels = std::vector<unsigned char>(bytes);
+
+    for (std::size_t i = 0; i < bytes; ++i) {
+        pixels[i] = static_cast<unsigned char>(i * 31 + i / 4096);
+    }
+
+    std::cout << "renderer: " << glGetString(GL_RENDERER) << "\n"
+              << "image: " << size << "x" << size << " RGBA8, "
+              << mip_level_count(size, size) << " levels, " << iterations
+              << " iterations\n";
+
+    int alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    {
+        auto const start = clock_type::now();
+
+        for (int i = 0; i < iterations; ++i) {
+            auto texture = Texture2D(size, size, GL_RGBA8);
+            texture.upload(0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+            texture.generate_mipmaps();
+            glFinish();
+        }
+
+        report("glGenerateMipmap", elapsed_ms(start), 0.0, iterations);
+    }
+
+    struct cpu_method {
+        char const *name;
+        mip_options options;
+    };
+
+    auto const methods = std::vector<cpu_method>{
+        {"box, 1 thread", {mip_filter::box, false, 1}},
+        {"box", {mip_filter::box, false, 0}},
+        {"box sRGB, 1 thread", {mip_filter::box, true, 1}},
+        {"box sRGB", {mip_filter::box, true, 0}},
+        {"kaiser, 1 thread", {mip_filter::kaiser, false, 1}},
+        {"kaiser", {mip_filter::kaiser, false, 0}},
+        {"kaiser sRGB, 1 thread", {mip_filter::kaiser, true, 1}},
+        {"kaiser sRGB", {mip_filter::kaiser, true, 0}},
+    };
+
+    for (auto const& method : methods) {
+        auto filter_ms = 0.0;
+        auto const start = clock_type::now();
+
+        for (int i = 0; i < iterations; ++i) {
+            auto const filter_start = clock_type::now();
+            auto const levels =
+                build_mip_chain(pixels.data(), size, size, 4, method.options);
+            filter_ms += elapsed_ms(filter_start);
+
+            auto texture = Texture2D(size, size, GL_RGBA8);
+            texture.upload(0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+            for (std::size_t level = 0; level < levels.size(); ++level) {
+                texture.upload(
+                    static_cast<int>(level) + 1,
+                    GL_RGBA,
+                    GL_UNSIGNED_BYTE,
+                    levels[level].pixels.data()
+                );
+            }
+
+            glFinish();
+        }
+
+        report(method.name, elapsed_ms(start), filter_ms, iterations);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,101 @@
+// Startup benchmark comparing serial shader compilation against a batch
+// submitted through `ShaderLibrary`.
+//
+//     learn_opengl_bench_shaders [programs]
+//
+// Run from the repository root so `shaders/` resolves. The program binary
+// cache and Mesa's on-disk shader cache are disabled so every program is
+// really compiled, on Mesa force software rendering with
+// `LIBGL_ALWAYS_SOFTWARE=1` to measure llvmpipe.
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// clang-format off
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+// clang-format on
+
+#include <gl_ext.h>
+#include <program_cache.h>
+#include <shader.h>
+#include <shader_library.h>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+double elapsed_ms(clock_type::time_point start) {
+    return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int const programs = argc > 1 ? std::atoi(argv[1]) : 32;
+
+    setenv("MESA_SHADER_CACHE_DISABLE", "true", 0);
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "bench", NULL, NULL);
+
+    if (window == NULL) {
+        std::cerr << "Failed to create GLFW window.\n";
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD.\n";
+        glfwTerminate();
+        return -1;
+    }
+
+    load_gl_extensions((GLADloadproc)glfwGetProcAddress);
+    program_cache::set_enabled(false);
+
+    std::cout << "renderer: " << glGetString(GL_RENDERER) << "\n"
+              << "parallel compile: "
+              << (GLEXT_KHR_parallel_shader_compile ? "yes" : "no") << "\n"
+              << "programs: " << programs << "\n";
+
+    {
+        auto const start = clock_type::now();
+        auto serial = std::vector<Shader>{};
+
+        for (int i = 0; i < programs; ++i) {
+            serial.emplace_back("shaders/basic.vert", "shaders/basic.frag");
+        }
+
+        std::cout << "serial:  " << elapsed_ms(start) << " ms\n";
+    }
+
+    {
+        auto const start = clock_type::now();
+        auto batch = ShaderLibrary();
+
+        for (int i = 0; i < programs; ++i) {
+            batch.add("basic" + std::to_string(i), "shaders/basic.vert", "shaders/basic.frag");
+        }
+
+        auto const submitted = elapsed_ms(start);
+        batch.wait();
+
+        std::cout << "batched: " << elapsed_ms(start) << " ms"
+                  << " (submit " << submitted << " ms)\n";
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,160 @@
+// Texture upload throughput, glTexSubImage2D from client memory against
+// uploads staged through a persistently mapped `UploadRing`.
+//
+//     learn_opengl_bench_uploads [size] [iterations]
+//
+// Uploads a `size` x `size` RGBA8 image (default 2048) `iterations` times
+// (default 64) with each path and reports MB/s including a final glFinish.
+// The ring path counts the copy into mapped memory, which the texture
+// loader does on its decode threads.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+// clang-format off
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+// clang-format on
+
+#include <gl_ext.h>
+#include <upload_ring.h>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+double elapsed_ms(clock_type::time_point start) {
+    return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+double megabytes_per_second(std::size_t bytes, double milliseconds) {
+    return static_cast<double>(bytes) / (1024.0 * 1024.0) / (milliseconds / 1000.0);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int const size = argc > 1 ? std::atoi(argv[1]) : 2048;
+    int const iterations = argc > 2 ? std::atoi(argv[2]) : 64;
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow *window = glfwCreateWindow(64, 64, "bench", NULL, NULL);
+
+    if (window == NULL) {
+        std::cerr << "Failed to create GLFW window.\n";
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD.\n";
+        glfwTerminate();
+        return -1;
+    }
+
+    load_gl_extensions((GLADloadproc)glfwGetProcAddress);
+
+    auto const bytes = static_cast<std::size_t>(size) * size * 4;
+    auto const total = bytes * iterations;
+    auto pixels = std::vector<unsigned char>(bytes);
+
+    for (std::size_t i = 0; i < bytes; ++i) {
+        pixels[i] = static_cast<unsigned char>(i * 31);
+    }
+
+    std::cout << "renderer: " << glGetString(GL_RENDERER) << "\n"
+              << "buffer storage: " << (UploadRing::supported() ? "yes" : "no") << "\n"
+              << "image: " << size << "x" << size << " RGBA8, " << iterations
+              << " uploads\n";
+
+    unsigned int texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(
+        GL_TEXTURE_2D,
+        0,
+        GL_RGBA8,
+        size,
+        size,
+        0,
+        GL_RGBA,
+        GL_UNSIGNED_BYTE,
+        NULL
+    );
+    glFinish();
+
+    {
+        auto const start = clock_type::now();
+
+        for (int i = 0; i < iterations; ++i) {
+            glTexSubImage2D(
+                GL_TEXTURE_2D,
+                0,
+                0,
+                0,
+                size,
+                size,
+                GL_RGBA,
+                GL_UNSIGNED_BYTE,
+                pixels.data()
+            );
+        }
+
+        glFinish();
+        auto const ms = elapsed_ms(start);
+        std::cout << "client memory: " << megabytes_per_second(total, ms) << " MB/s\n";
+    }
+
+    if (UploadRing::supported()) {
+        // room for a few uploads in flight
+        auto ring = UploadRing(bytes * 3);
+        auto const start = clock_type::now();
+
+        for (int i = 0; i < iterations; ++i) {
+            auto region = upload_region{};
+
+            while (!ring.allocate(bytes, region)) {
+                ring.reclaim();
+            }
+
+            std::memcpy(region.data, pixels.data(), bytes);
+
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring.ID);
+            glTexSubImage2D(
+                GL_TEXTURE_2D,
+                0,
+                0,
+                0,
+                size,
+                size,
+                GL_RGBA,
+                GL_UNSIGNED_BYTE,
+                reinterpret_cast<void const *>(region.offset)
+            );
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+            ring.submit(region);
+            ring.fence();
+        }
+
+        glFinish();
+        auto const ms = elapsed_ms(start);
+        std::cout << "upload ring:   " << megabytes_per_second(total, ms) << " MB/s\n";
+    }
+
+    glDeleteTextures(1, &texture);
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
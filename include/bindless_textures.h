@@ -0,0 +1,65 @@
+#ifndef BINDLESS_TEXTURES_H
+#define BINDLESS_TEXTURES_H
+
+#include <cstdint>
+#include <vector>
+
+#include <uniform_buffer.h>
+
+// Resident ARB_bindless_texture handles laid out in a uniform block, so a
+// shader picks its textures by slot and draws need no texture units at
+// all. The block is `layout (std140) uniform texture_handles { uvec4
+// handles[capacity / 2]; }`, two handles per element, and a slot's handle
+// is `handles[slot / 2].xy` for even slots and `.zw` for odd ones.
+//
+// A texture and its sampler become immutable once a handle to them exists,
+// so only add textures that are fully uploaded. Only usable when
+// `supported` is true.
+class BindlessTextureTable {
+public:
+    // room for `capacity` handles, rounded up to an even count, in a
+    // uniform buffer attached to `binding`
+    BindlessTextureTable(int capacity, unsigned int binding);
+
+    // makes every handle still in the table non-resident
+    ~BindlessTextureTable();
+
+    BindlessTextureTable(BindlessTextureTable const&) = delete;
+    BindlessTextureTable& operator=(BindlessTextureTable const&) = delete;
+
+    BindlessTextureTable(BindlessTextureTable&& other) noexcept;
+    BindlessTextureTable& operator=(BindlessTextureTable&& other) noexcept;
+
+    // make `texture` sampled through `sampler` resident, 0 samples with the
+    // texture's own parameters. Adding the same pair again returns the same
+    // slot, returns -1 if the table is full
+    int add(unsigned int texture, unsigned int sampler = 0);
+
+    // drop a reference taken by `add`, the handle is made non-resident and
+    // its slot reused once every reference is gone, -1 is ignored
+    void remove(int slot);
+
+    // upload the slots changed since the last call
+    void update();
+
+    int capacity() const { return static_cast<int>(handles.size()); }
+
+    unsigned int binding() const { return buffer.binding(); }
+
+    static bool supported();
+
+private:
+    UniformBuffer buffer;
+
+    // 0 for free slots
+    std::vector<std::uint64_t> handles;
+    std::vector<int> refs;
+
+    // range of slots to upload, empty when `dirty_begin >= dirty_end`
+    int dirty_begin = 0;
+    int dirty_end = 0;
+
+    void release();
+};
+
+#endif // BINDLESS_TEXTURES_H
@@ -0,0 +1,45 @@
+#ifndef BLOCK_COMPRESSION_H
+#define BLOCK_COMPRESSION_H
+
+#include <cstddef>
+#include <vector>
+
+// block-compressed formats the encoder can produce, all use 4x4 blocks
+enum class block_format {
+    // RGB, 8 bytes per block (S3TC DXT1)
+    bc1,
+    // RGBA with interpolated alpha, 16 bytes per block (S3TC DXT5)
+    bc3,
+    // RGBA, 16 bytes per block (BPTC), only mode 6 is emitted
+    bc7,
+    // RGB, 8 bytes per block, ETC1 compatible blocks only
+    etc2_rgb,
+};
+
+// trades encode time for quality. For BC1, BC3 and BC7 `fast` uses bounding
+// box endpoints, `normal` fits a principal axis and refines once, `high`
+// refines up to four times. For ETC2 `fast` tries one subblock orientation,
+// `normal` tries both and `high` also searches the base colours neighbouring
+// each subblock's average
+enum class compression_quality {
+    fast,
+    normal,
+    high,
+};
+
+// GL internal format of `format`, eg. GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+unsigned int compressed_internal_format(block_format format, bool srgb);
+
+// encode a tightly packed RGBA8 image, blocks over the edge repeat the last
+// row and column. Rows of blocks are split across `threads` threads, 0 uses
+// every hardware thread
+std::vector<unsigned char> compress_image(
+    unsigned char const *rgba,
+    int width,
+    int height,
+    block_format format,
+    compression_quality quality = compression_quality::normal,
+    unsigned int threads = 0
+);
+
+#endif // BLOCK_COMPRESSION_H
@@ -0,0 +1,25 @@
+#ifndef FILE_LOADER_H
+#define FILE_LOADER_H
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+struct loaded_file {
+    std::filesystem::path path;
+    std::string contents;
+    bool ok;
+};
+
+// read the whole file at `path` into `out`, the buffer is sized once from
+// the file size and filled with a single read, returns false on error
+bool read_file(std::filesystem::path const& path, std::string& out);
+
+// read every file in `paths` in one pass, results are in the same order
+std::vector<loaded_file> read_files(std::vector<std::filesystem::path> const& paths);
+
+// name next to `path` to write before renaming over it, unique per process
+// and call so concurrent writers of the same file never share one
+std::filesystem::path temporary_path(std::filesystem::path const& path);
+
+#endif // FILE_LOADER_H
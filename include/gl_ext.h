@@ -0,0 +1,189 @@
+#ifndef GL_EXT_H
+#define GL_EXT_H
+
+// Optional GL 4.x / extension entry points used on top of the 3.3 core glad
+// loader. Each feature flag is set by `load_gl_extensions` when the context
+// exposes it either as core or as an extension, and every entry point must
+// only be called when its flag is set.
+
+#include <glad/glad.h>
+
+// ---- ARB_get_program_binary (core in 4.1) ----
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#define GL_PROGRAM_BINARY_FORMATS 0x87FF
+#endif
+
+typedef void (APIENTRYP PFNGLGETPROGRAMBINARYPROC)(
+    GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary
+);
+typedef void (APIENTRYP PFNGLPROGRAMBINARYPROC)(
+    GLuint program, GLenum binaryFormat, const void *binary, GLsizei length
+);
+typedef void (APIENTRYP PFNGLPROGRAMPARAMETERIPROC)(
+    GLuint program, GLenum pname, GLint value
+);
+
+extern int GLEXT_ARB_get_program_binary;
+extern PFNGLGETPROGRAMBINARYPROC glext_glGetProgramBinary;
+extern PFNGLPROGRAMBINARYPROC glext_glProgramBinary;
+extern PFNGLPROGRAMPARAMETERIPROC glext_glProgramParameteri;
+#define glGetProgramBinary glext_glGetProgramBinary
+#define glProgramBinary glext_glProgramBinary
+#define glProgramParameteri glext_glProgramParameteri
+
+// ---- KHR_parallel_shader_compile / ARB_parallel_shader_compile ----
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+
+extern int GLEXT_KHR_parallel_shader_compile;
+extern PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glext_glMaxShaderCompilerThreadsKHR;
+#define glMaxShaderCompilerThreadsKHR glext_glMaxShaderCompilerThreadsKHR
+
+// ---- ARB_separate_shader_objects (core in 4.1) ----
+#ifndef GL_PROGRAM_SEPARABLE
+#define GL_VERTEX_SHADER_BIT 0x00000001
+#define GL_FRAGMENT_SHADER_BIT 0x00000002
+#define GL_ALL_SHADER_BITS 0xFFFFFFFF
+#define GL_PROGRAM_SEPARABLE 0x8258
+#define GL_ACTIVE_PROGRAM 0x8259
+#define GL_PROGRAM_PIPELINE_BINDING 0x825A
+#endif
+
+typedef void (APIENTRYP PFNGLUSEPROGRAMSTAGESPROC)(
+    GLuint pipeline, GLbitfield stages, GLuint program
+);
+typedef void (APIENTRYP PFNGLACTIVESHADERPROGRAMPROC)(GLuint pipeline, GLuint program);
+typedef void (APIENTRYP PFNGLGENPROGRAMPIPELINESPROC)(GLsizei n, GLuint *pipelines);
+typedef void (APIENTRYP PFNGLDELETEPROGRAMPIPELINESPROC)(
+    GLsizei n, const GLuint *pipelines
+);
+typedef void (APIENTRYP PFNGLBINDPROGRAMPIPELINEPROC)(GLuint pipeline);
+typedef void (APIENTRYP PFNGLVALIDATEPROGRAMPIPELINEPROC)(GLuint pipeline);
+typedef void (APIENTRYP PFNGLGETPROGRAMPIPELINEIVPROC)(
+    GLuint pipeline, GLenum pname, GLint *params
+);
+typedef void (APIENTRYP PFNGLGETPROGRAMPIPELINEINFOLOGPROC)(
+    GLuint pipeline, GLsizei bufSize, GLsizei *length, GLchar *infoLog
+);
+
+// glProgramParameteri is shared with ARB_get_program_binary
+extern int GLEXT_ARB_separate_shader_objects;
+extern PFNGLUSEPROGRAMSTAGESPROC glext_glUseProgramStages;
+extern PFNGLACTIVESHADERPROGRAMPROC glext_glActiveShaderProgram;
+extern PFNGLGENPROGRAMPIPELINESPROC glext_glGenProgramPipelines;
+extern PFNGLDELETEPROGRAMPIPELINESPROC glext_glDeleteProgramPipelines;
+extern PFNGLBINDPROGRAMPIPELINEPROC glext_glBindProgramPipeline;
+extern PFNGLVALIDATEPROGRAMPIPELINEPROC glext_glValidateProgramPipeline;
+extern PFNGLGETPROGRAMPIPELINEIVPROC glext_glGetProgramPipelineiv;
+extern PFNGLGETPROGRAMPIPELINEINFOLOGPROC glext_glGetProgramPipelineInfoLog;
+#define glUseProgramStages glext_glUseProgramStages
+#define glActiveShaderProgram glext_glActiveShaderProgram
+#define glGenProgramPipelines glext_glGenProgramPipelines
+#define glDeleteProgramPipelines glext_glDeleteProgramPipelines
+#define glBindProgramPipeline glext_glBindProgramPipeline
+#define glValidateProgramPipeline glext_glValidateProgramPipeline
+#define glGetProgramPipelineiv glext_glGetProgramPipelineiv
+#define glGetProgramPipelineInfoLog glext_glGetProgramPipelineInfoLog
+
+// ---- ARB_buffer_storage (core in 4.4) ----
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+#endif
+
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(
+    GLenum target, GLsizeiptr size, const void *data, GLbitfield flags
+);
+
+extern int GLEXT_ARB_buffer_storage;
+extern PFNGLBUFFERSTORAGEPROC glext_glBufferStorage;
+#define glBufferStorage glext_glBufferStorage
+
+// ---- ARB_texture_storage (core in 4.2) ----
+#ifndef GL_TEXTURE_IMMUTABLE_FORMAT
+#define GL_TEXTURE_IMMUTABLE_FORMAT 0x912F
+#endif
+
+typedef void (APIENTRYP PFNGLTEXSTORAGE2DPROC)(
+    GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height
+);
+
+typedef void (APIENTRYP PFNGLTEXSTORAGE3DPROC)(
+    GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height,
+    GLsizei depth
+);
+
+// set only when both the 2D and 3D entry points loaded
+extern int GLEXT_ARB_texture_storage;
+extern PFNGLTEXSTORAGE2DPROC glext_glTexStorage2D;
+extern PFNGLTEXSTORAGE3DPROC glext_glTexStorage3D;
+#define glTexStorage2D glext_glTexStorage2D
+#define glTexStorage3D glext_glTexStorage3D
+
+// ---- ARB_bindless_texture, extension only ----
+typedef GLuint64 (APIENTRYP PFNGLGETTEXTUREHANDLEARBPROC)(GLuint texture);
+typedef GLuint64 (APIENTRYP PFNGLGETTEXTURESAMPLERHANDLEARBPROC)(
+    GLuint texture, GLuint sampler
+);
+typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLERESIDENTARBPROC)(GLuint64 handle);
+typedef void (APIENTRYP PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC)(GLuint64 handle);
+
+extern int GLEXT_ARB_bindless_texture;
+extern PFNGLGETTEXTUREHANDLEARBPROC glext_glGetTextureHandleARB;
+extern PFNGLGETTEXTURESAMPLERHANDLEARBPROC glext_glGetTextureSamplerHandleARB;
+extern PFNGLMAKETEXTUREHANDLERESIDENTARBPROC glext_glMakeTextureHandleResidentARB;
+extern PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC glext_glMakeTextureHandleNonResidentARB;
+#define glGetTextureHandleARB glext_glGetTextureHandleARB
+#define glGetTextureSamplerHandleARB glext_glGetTextureSamplerHandleARB
+#define glMakeTextureHandleResidentARB glext_glMakeTextureHandleResidentARB
+#define glMakeTextureHandleNonResidentARB glext_glMakeTextureHandleNonResidentARB
+
+// ---- compressed texture formats, enums only ----
+// EXT_texture_compression_s3tc, sRGB variants from EXT_texture_sRGB
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+
+// ARB_texture_compression_bptc (core in 4.2)
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+
+// ARB_ES3_compatibility (core in 4.3)
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#define GL_COMPRESSED_SRGB8_ETC2 0x9275
+#endif
+
+extern int GLEXT_EXT_texture_compression_s3tc;
+extern int GLEXT_EXT_texture_sRGB_s3tc;
+extern int GLEXT_ARB_texture_compression_bptc;
+extern int GLEXT_ARB_ES3_compatibility;
+
+// query the current context and load the optional entry points above,
+// must be called after `gladLoadGLLoader`
+void load_gl_extensions(GLADloadproc load);
+
+// true if the current context is at least GL `major.minor`
+bool has_gl_version(int major, int minor);
+
+// true if the current context lists `name` in GL_EXTENSIONS
+bool has_gl_extension(char const *name);
+
+#endif // GL_EXT_H
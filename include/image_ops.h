@@ -0,0 +1,51 @@
+#ifndef IMAGE_OPS_H
+#define IMAGE_OPS_H
+
+#include <cstddef>
+
+// transforms applied to an 8-bit image once it is decoded, so none of them
+// depend on decoder state shared between loads
+struct image_options {
+    // store the image bottom row first as OpenGL expects
+    bool flip = false;
+    // widen three channel images to RGBA with opaque alpha, the layout
+    // drivers upload without converting
+    bool expand_rgba = false;
+    // swap the first and third channel, for BGR and BGRA sources
+    bool swizzle_bgra = false;
+    // multiply colour by alpha, so blending uses GL_ONE and
+    // GL_ONE_MINUS_SRC_ALPHA and filtering doesn't bleed the colour of
+    // transparent texels
+    bool premultiply = false;
+
+    bool operator==(image_options const&) const = default;
+};
+
+// reverse the order of `height` rows of `row_bytes` bytes in place
+void flip_rows(unsigned char *pixels, std::size_t row_bytes, int height);
+
+// widen `count` RGB texels to RGBA, the buffers must not overlap
+void expand_rgb_to_rgba(
+    unsigned char const *rgb,
+    unsigned char *rgba,
+    std::size_t count
+);
+
+// swap the first and third channel of `count` texels of 3 or 4 channels
+void swizzle_bgra(unsigned char *pixels, std::size_t count, int channels);
+
+// multiply the colour of `count` texels by their alpha, the last of 2 or 4
+// channels, rounding to nearest. Other channel counts have no alpha
+void premultiply_alpha(unsigned char *pixels, std::size_t count, int channels);
+
+// flip, swizzle and premultiply an image in place as `options` asks,
+// `expand_rgba` changes the image size and is left to the caller
+void transform_image(
+    unsigned char *pixels,
+    int width,
+    int height,
+    int channels,
+    image_options const& options
+);
+
+#endif // IMAGE_OPS_H
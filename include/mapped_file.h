@@ -0,0 +1,76 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+// how a mapping will be read, passed to madvise where available
+enum class file_access {
+    normal,
+    // read front to back once, eg. by an image decoder; the kernel reads
+    // ahead aggressively and drops pages behind the reader
+    sequential,
+    // read in no particular order, read-ahead is disabled
+    random,
+};
+
+// Read-only view of a whole file. The file is memory mapped where the
+// platform supports it and read into memory otherwise.
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(
+        std::filesystem::path const& path,
+        file_access access = file_access::normal
+    );
+
+    ~MappedFile();
+
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // false if the file could not be opened or is empty
+    bool ok() const { return bytes != nullptr; }
+
+    unsigned char const *data() const { return bytes; }
+
+    std::size_t size() const { return length; }
+
+    // change the access hint of the whole mapping, a no-op when the file was
+    // read into memory
+    void advise(file_access access) const;
+
+private:
+    unsigned char const *bytes = nullptr;
+    std::size_t length = 0;
+    bool mapped = false;
+
+    // holds the contents when mapping is unavailable
+    std::string contents;
+
+    void close();
+};
+
+// Process-wide cache of read-only mappings shared between threads. Opening
+// a path that is already mapped returns the same mapping instead of mapping
+// the file again; it is unmapped when the last holder releases it. Files
+// that can't be opened are not cached, the result is then not `ok`.
+namespace mapping_cache {
+
+std::shared_ptr<MappedFile const> open(
+    std::filesystem::path const& path,
+    file_access access = file_access::sequential
+);
+
+// number of files currently mapped through the cache
+std::size_t size();
+
+} // namespace mapping_cache
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,51 @@
+#ifndef MIPMAP_H
+#define MIPMAP_H
+
+#include <vector>
+
+// one level of a mip chain, rows are tightly packed
+struct mip_level {
+    int width;
+    int height;
+    std::vector<unsigned char> pixels;
+};
+
+enum class mip_filter {
+    // 2x2 average, cheap and slightly blurry
+    box,
+    // Kaiser-windowed sinc over 6x6 texels, keeps more detail in lower
+    // levels at the cost of a little ringing
+    kaiser,
+};
+
+struct mip_options {
+    mip_filter filter = mip_filter::box;
+    // the first three channels are sRGB encoded and are filtered in linear
+    // light, a fourth (alpha) channel is always linear
+    bool srgb = false;
+    // rows of each level are split across `threads` threads, 0 uses every
+    // hardware thread
+    unsigned int threads = 0;
+};
+
+// halve an 8-bit image with `channels` interleaved channels. The box filter
+// drops an odd last row or column, a single row or column is reused
+mip_level downsample(
+    unsigned char const *pixels,
+    int width,
+    int height,
+    int channels,
+    mip_options const& options = {}
+);
+
+// every level below `pixels` down to 1x1, level 1 first. Levels other
+// than a plain box filter are computed from the unrounded level above
+std::vector<mip_level> build_mip_chain(
+    unsigned char const *pixels,
+    int width,
+    int height,
+    int channels,
+    mip_options const& options = {}
+);
+
+#endif // MIPMAP_H
@@ -0,0 +1,40 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <initializer_list>
+#include <string_view>
+
+// On-disk cache of linked program binaries (ARB_get_program_binary). Entries
+// are keyed by the shader sources, defines and the driver's vendor, renderer
+// and version strings, so a driver update invalidates every entry. All
+// functions are no-ops when the context does not support program binaries.
+namespace program_cache {
+
+// directory holding cached binaries, defaults to `shader_cache`
+void set_directory(std::filesystem::path const& directory);
+
+std::filesystem::path const& directory();
+
+// enable or disable loading and storing binaries, enabled by default
+void set_enabled(bool enabled);
+
+// cache key for a program built from `sources` with `defines` injected,
+// requires a current context
+std::uint64_t key(std::initializer_list<std::string_view> sources, std::string_view defines);
+
+// hint to the driver that `program` will be retrieved, call before linking
+void prepare(unsigned int program);
+
+// load the binary for `key` into `program`, returns false if there is no
+// entry or the driver rejected it, in which case `program` must be built
+// from source
+bool load(unsigned int program, std::uint64_t key);
+
+// write the binary of the linked `program` under `key`
+void store(unsigned int program, std::uint64_t key);
+
+} // namespace program_cache
+
+#endif // PROGRAM_CACHE_H
@@ -0,0 +1,98 @@
+#ifndef PROGRAM_PIPELINE_H
+#define PROGRAM_PIPELINE_H
+
+#include <shader.h>
+
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Program pipeline object combining a separable vertex program with a
+// separable fragment program (ARB_separate_shader_objects). Stages are
+// combined without a link, so swapping one stage is a state change rather
+// than a recompile.
+class ProgramPipeline {
+public:
+    unsigned int ID;
+
+    // both shaders must be separable and outlive the pipeline
+    ProgramPipeline(Shader const& vertex, Shader const& fragment);
+
+    ~ProgramPipeline();
+
+    ProgramPipeline(ProgramPipeline const&) = delete;
+    ProgramPipeline& operator=(ProgramPipeline const&) = delete;
+
+    ProgramPipeline(ProgramPipeline&& other) noexcept;
+    ProgramPipeline& operator=(ProgramPipeline&& other) noexcept;
+
+    // true if the context supports separable programs
+    static bool supported();
+
+    // unbind any program and bind the pipeline, stages whose program was
+    // replaced by `Shader::reload` are re-attached first
+    void use();
+
+    // route `set_uniform` calls to the program of `stage`, the pipeline
+    // must be bound
+    void activate(Shader const& stage);
+
+    // check the stages are compatible, errors are reported on stderr
+    bool validate();
+
+    Shader const& vertex() const { return *vertex_stage; }
+
+    Shader const& fragment() const { return *fragment_stage; }
+
+private:
+    Shader const *vertex_stage;
+    Shader const *fragment_stage;
+
+    // programs currently attached, compared with the stages' IDs on `use`
+    unsigned int attached_vertex = 0;
+    unsigned int attached_fragment = 0;
+
+    void attach();
+};
+
+// Separable stages cached by stage, path and permutation, and the pipelines
+// built from them. N vertex and M fragment variants cost N + M compiles
+// instead of N * M links. References stay valid for the lifetime of the
+// cache.
+class StageCache {
+public:
+    // compile the stage on first use, later calls return the cached one
+    Shader& stage(
+        shader_stage kind,
+        std::string_view path,
+        shader_defines const& defines = {}
+    );
+
+    ProgramPipeline& pipeline(Shader const& vertex, Shader const& fragment);
+
+    // pipeline from two stages sharing `defines`
+    ProgramPipeline& pipeline(
+        std::string_view vertex_path,
+        std::string_view frag_path,
+        shader_defines const& defines = {}
+    );
+
+    std::size_t stage_count() const { return stages.size(); }
+
+    std::size_t pipeline_count() const { return pipelines.size(); }
+
+private:
+    // one entry per stage permutation, deques so references are never
+    // invalidated
+    std::vector<shader_stage> stage_kinds;
+    std::vector<std::filesystem::path> stage_paths;
+    std::vector<std::string> stage_keys;
+    std::deque<Shader> stages;
+
+    std::deque<ProgramPipeline> pipelines;
+};
+
+#endif // PROGRAM_PIPELINE_H
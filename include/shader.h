@@ -3,36 +3,318 @@
 
 #include <glad/glad.h>
 
+#include <shader_preprocessor.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <string>
 #include <string_view>
+#include <vector>
+
+// 32-bit FNV-1a hash used to key uniform names
+constexpr std::uint32_t fnv1a(std::string_view str) {
+    std::uint32_t hash = 2166136261u;
+
+    for (char const c : str) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+// uniform name hashed at compile time, eg. `"transform"_uniform`
+struct uniform_id {
+    std::uint32_t hash;
+
+    consteval explicit uniform_id(std::string_view name) : hash(fnv1a(name)) {}
+};
+
+consteval uniform_id operator""_uniform(char const *name, std::size_t length) {
+    return uniform_id{std::string_view{name, length}};
+}
+
+// index into a shader's cached uniform locations, resolved once with
+// `Shader::uniform`
+struct uniform_handle {
+    int index = -1;
+};
+
+// preprocessed sources of a program and every file they were built from
+struct shader_sources {
+    std::string vertex;
+    std::string fragment;
+    std::vector<std::filesystem::path> dependencies;
+};
+
+// reflected default-block uniform, `location` is -1 if the uniform stopped
+// being active after a `reload`
+struct uniform_info {
+    std::string name;
+    int location;
+    unsigned int type;
+    int size;
+    // first texture unit of a sampler, -1 for other uniforms
+    int unit;
+};
+
+// reflected vertex shader input
+struct attribute_info {
+    std::string name;
+    int location;
+    unsigned int type;
+    int size;
+};
+
+struct uniform_block_info {
+    std::string name;
+    unsigned int index;
+    int data_size;
+    unsigned int binding;
+};
+
+// uniform uploads since the last `reset_uniform_stats`, `skipped` counts
+// `set_uniform` calls whose value matched what the program already had
+struct uniform_stats {
+    std::size_t issued = 0;
+    std::size_t skipped = 0;
+};
+
+// one attribute of a vertex format as set up with glVertexAttribPointer
+struct vertex_attribute {
+    int location;
+    int components;
+};
+
+// `immediate` compiles and links in the constructor, `deferred` only
+// submits the work to the driver and leaves status queries to `finish`
+enum class compile_mode {
+    immediate,
+    deferred,
+};
+
+// single stage of a separable program, see `ProgramPipeline`
+enum class shader_stage {
+    vertex,
+    fragment,
+};
 
 class Shader {
 public:
     unsigned int ID;
 
-    Shader(std::string_view vertex_path, std::string_view frag_path);
+    Shader(
+        std::string_view vertex_path,
+        std::string_view frag_path,
+        shader_defines defines = {},
+        compile_mode mode = compile_mode::immediate
+    );
+
+    // separable program holding only `stage`, requires
+    // ARB_separate_shader_objects and is used through a `ProgramPipeline`
+    Shader(
+        shader_stage stage,
+        std::string_view path,
+        shader_defines defines = {},
+        compile_mode mode = compile_mode::immediate
+    );
 
     ~Shader();
 
+    Shader(Shader const&) = delete;
+    Shader& operator=(Shader const&) = delete;
+
+    Shader(Shader&& other) noexcept;
+    Shader& operator=(Shader&& other) noexcept;
+
+    // true once a deferred compile can be finished without stalling, always
+    // true when KHR_parallel_shader_compile is unavailable
+    bool ready() const;
+
+    // complete a deferred compile, blocking if it is not ready yet, and
+    // report any errors, returns whether the program linked
+    bool finish();
+
+    bool compiling() const { return pending; }
+
+    // rebuild the program from new sources, the current program is only
+    // replaced if the new one links, returns whether it was replaced
+    bool reload(std::string const& vertex_source, std::string const& fragment_source);
+
+    std::filesystem::path const& vertex_path() const { return vert_path; }
+
+    std::filesystem::path const& fragment_path() const { return frag_path; }
+
+    shader_defines const& defines() const { return program_defines; }
+
+    bool separable() const { return is_separable; }
+
+    // key of the program's entry in the `program_cache`
+    std::uint64_t program_key() const { return cache_key; }
+
+    // read and preprocess the program's source files with its defines, only
+    // touches immutable state so it is safe to call from any thread
+    shader_sources read_sources() const;
+
     void cleanup();
 
     // activate shader
     void use();
 
-    // set uniforms in shaders
+    // look up a uniform in the location cache, returns an invalid handle
+    // if the uniform is not active in the program
+    uniform_handle uniform(std::string_view name) const;
+
+    uniform_handle uniform(uniform_id id) const;
+
+    int location(uniform_handle handle) const;
+
+    uniform_stats uniform_upload_stats() const { return upload_stats; }
+
+    void reset_uniform_stats() { upload_stats = uniform_stats{}; }
+
+    // program interface reflected after each link
+    std::vector<uniform_info> const& uniforms() const { return uniform_infos; }
+
+    std::vector<attribute_info> const& attributes() const { return attribute_infos; }
+
+    std::vector<uniform_block_info> const& uniform_blocks() const { return block_infos; }
+
+    // texture unit assigned to a sampler uniform, or -1. Units are assigned
+    // after link in declaration order and kept across `reload`
+    int sampler_unit(std::string_view name) const;
+
+    int sampler_unit(uniform_handle handle) const;
+
+    // check that every active vertex input is fed by an attribute of
+    // `layout` with a matching component count, mismatches are reported on
+    // stderr
+    bool validate_vertex_layout(std::vector<vertex_attribute> const& layout) const;
+
+    // attach the uniform block `name` to a binding point shared with a
+    // `UniformBuffer`, returns false if the block is not active, the binding
+    // is remembered and restored on `reload`
+    bool bind_uniform_block(std::string_view name, unsigned int binding);
+
+    // set uniforms in shaders, the GL call is skipped when the value is
+    // bit-identical to the last one uploaded to this program
     template <typename T>
-    void set_uniform(std::string const&, T const&) const;
+    void set_uniform(uniform_handle, T const&) const;
 
     template <typename T>
-    void set_uniform(std::string const&, T const, T const) const;
+    void set_uniform(uniform_handle, T const, T const) const;
 
     template <typename T>
-    void set_uniform(std::string const&, T const, T const, T const) const;
+    void set_uniform(uniform_handle, T const, T const, T const) const;
 
     template <typename T>
-    void set_uniform(std::string const&, T const, T const, T const, T const) const;
+    void set_uniform(uniform_handle, T const, T const, T const, T const) const;
+
+    template <typename T>
+    void set_uniform(std::string_view name, T const& value) const {
+        set_uniform<T>(uniform(name), value);
+    }
+
+    template <typename T>
+    void set_uniform(std::string_view name, T const x, T const y) const {
+        set_uniform<T>(uniform(name), x, y);
+    }
+
+    template <typename T>
+    void set_uniform(std::string_view name, T const x, T const y, T const z) const {
+        set_uniform<T>(uniform(name), x, y, z);
+    }
+
+    template <typename T>
+    void set_uniform(
+        std::string_view name,
+        T const x,
+        T const y,
+        T const z,
+        T const w
+    ) const {
+        set_uniform<T>(uniform(name), x, y, z, w);
+    }
+
+    template <typename T>
+    void set_uniform(uniform_id id, T const& value) const {
+        set_uniform<T>(uniform(id), value);
+    }
+
+    template <typename T>
+    void set_uniform(uniform_id id, T const x, T const y) const {
+        set_uniform<T>(uniform(id), x, y);
+    }
+
+    template <typename T>
+    void set_uniform(uniform_id id, T const x, T const y, T const z) const {
+        set_uniform<T>(uniform(id), x, y, z);
+    }
+
+    template <typename T>
+    void set_uniform(
+        uniform_id id,
+        T const x,
+        T const y,
+        T const z,
+        T const w
+    ) const {
+        set_uniform<T>(uniform(id), x, y, z, w);
+    }
+
+private:
+    std::filesystem::path vert_path;
+    std::filesystem::path frag_path;
+    shader_defines program_defines;
+    // a separable program leaves the path of its missing stage empty
+    bool is_separable = false;
+
+    // populated after each link from GL_ACTIVE_UNIFORMS, indexed by
+    // `uniform_handle::index`
+    std::vector<uniform_info> uniform_infos;
+    std::vector<std::uint32_t> uniform_hashes;
+    std::vector<int> uniform_locations;
+
+    // last value uploaded to each slot, `size` is 0 when unknown
+    struct uniform_shadow {
+        std::array<unsigned char, sizeof(float) * 16> data;
+        unsigned char size = 0;
+    };
+
+    mutable std::vector<uniform_shadow> uniform_shadows;
+    mutable uniform_stats upload_stats;
+
+    std::vector<attribute_info> attribute_infos;
+    std::vector<uniform_block_info> block_infos;
+
+    std::vector<std::string> block_names;
+    std::vector<unsigned int> block_bindings;
+
+    // in-flight deferred compile
+    unsigned int pending_vertex = 0;
+    unsigned int pending_fragment = 0;
+    std::uint64_t cache_key = 0;
+    bool pending = false;
+    bool linked = false;
+
+    void submit(std::string const& vertex_shader, std::string const& fragment_shader);
+
+    // compare `data` with the shadow copy of `handle` and update it, returns
+    // true if the value must be uploaded
+    bool changed(uniform_handle handle, void const *data, std::size_t size) const;
+
+    void reflect();
+
+    void reflect_uniforms();
+
+    void reflect_attributes();
+
+    void reflect_uniform_blocks();
+
+    void assign_sampler_units();
 };
 
 
 #endif // SHADER_H
-
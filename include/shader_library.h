@@ -0,0 +1,66 @@
+#ifndef SHADER_LIBRARY_H
+#define SHADER_LIBRARY_H
+
+#include <shader.h>
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Named set of programs compiled in bulk. Programs are submitted with
+// `compile_mode::deferred` so the driver can compile them in parallel
+// (KHR_parallel_shader_compile) while the caller does other loading work,
+// and are finished as they become ready.
+//
+// Each name can have several permutations built with different
+// `shader_defines`. Only the permutations that are asked for are compiled,
+// and each is compiled once and cached by its `permutation_key`.
+class ShaderLibrary {
+public:
+    ShaderLibrary();
+
+    // register a program and submit the permutation built with `defines`,
+    // returns without waiting on the driver
+    void add(
+        std::string name,
+        std::string_view vertex_path,
+        std::string_view frag_path,
+        shader_defines const& defines = {}
+    );
+
+    // submit another permutation of a registered program, does nothing if
+    // it was already requested
+    void request(std::string_view name, shader_defines const& defines);
+
+    // finish every program the driver has completed without stalling,
+    // returns the number of programs still compiling
+    std::size_t poll();
+
+    // finish every outstanding program, blocking as needed
+    void wait();
+
+    bool ready() { return poll() == 0; }
+
+    std::size_t size() const { return shaders.size(); }
+
+    // number of programs that have been finished
+    std::size_t ready_count() const;
+
+    // look up a permutation of a program, it is compiled if it was never
+    // requested and finished first if still compiling, references stay
+    // valid for the lifetime of the library
+    Shader& get(std::string_view name, shader_defines const& defines = {});
+
+private:
+    // one entry per permutation, a deque so references are never invalidated
+    std::vector<std::string> names;
+    std::vector<std::string> keys;
+    std::deque<Shader> shaders;
+
+    // index of the permutation `key` of `name`, or -1
+    int find(std::string_view name, std::string_view key) const;
+};
+
+#endif // SHADER_LIBRARY_H
@@ -0,0 +1,39 @@
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// `#define name value` injected into every stage of a program
+struct shader_define {
+    std::string name;
+    std::string value;
+};
+
+using shader_defines = std::vector<shader_define>;
+
+// canonical key naming a permutation, independent of the order of `defines`,
+// eg. "SHADOWS=2;WIREFRAME"
+std::string permutation_key(shader_defines const& defines);
+
+// Read the GLSL file at `path`, expand `#include "file"` directives relative
+// to the including file and inject `defines` after the `#version` line.
+// Every file is included at most once. The files read are appended to
+// `dependencies` when it is not null. Errors are reported on stderr and the
+// offending directive is dropped.
+std::string preprocess_shader(
+    std::filesystem::path const& path,
+    shader_defines const& defines,
+    std::vector<std::filesystem::path> *dependencies = nullptr
+);
+
+// same as above for a root file whose contents were already read
+std::string preprocess_shader(
+    std::filesystem::path const& path,
+    std::string const& source,
+    shader_defines const& defines,
+    std::vector<std::filesystem::path> *dependencies = nullptr
+);
+
+#endif // SHADER_PREPROCESSOR_H
@@ -0,0 +1,64 @@
+#ifndef SHADER_WATCHER_H
+#define SHADER_WATCHER_H
+
+#include <shader.h>
+
+#include <atomic>
+#include <cstddef>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Hot-reloads shaders when their source files, or any file they include,
+// change. A background thread waits on inotify, and re-reads and
+// preprocesses the sources of affected programs when a file is written.
+// The GL work happens in `apply`, which is meant to be called once per
+// frame from the thread owning the context. On platforms without inotify
+// the watcher does nothing.
+class ShaderWatcher {
+public:
+    ShaderWatcher();
+
+    ~ShaderWatcher();
+
+    ShaderWatcher(ShaderWatcher const&) = delete;
+    ShaderWatcher& operator=(ShaderWatcher const&) = delete;
+
+    // reload `shader` whenever one of its source files changes, `shader`
+    // must outlive the watcher and must not be moved
+    void watch(Shader& shader);
+
+    // relink every program whose sources changed since the last call, a
+    // program is only swapped if the new one links, returns the number of
+    // programs that were replaced
+    std::size_t apply();
+
+private:
+    struct pending_reload {
+        Shader *shader;
+        shader_sources sources;
+    };
+
+    int inotify_fd = -1;
+    std::vector<int> watch_fds;
+    std::vector<std::filesystem::path> watch_dirs;
+    std::vector<Shader *> shaders;
+    std::vector<std::vector<std::filesystem::path>> dependencies;
+
+    std::mutex mutex;
+    std::vector<pending_reload> pending;
+
+    std::atomic<bool> running = false;
+    std::thread worker;
+
+    void run();
+
+    void changed(std::filesystem::path const& path);
+
+    // start watching the directory of every file in `files`, the mutex must
+    // be held
+    void watch_directories(std::vector<std::filesystem::path> const& files);
+};
+
+#endif // SHADER_WATCHER_H
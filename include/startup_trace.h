@@ -0,0 +1,38 @@
+#ifndef STARTUP_TRACE_H
+#define STARTUP_TRACE_H
+
+#include <chrono>
+#include <ostream>
+#include <string>
+
+// Named timings collected while the application starts up and printed with
+// `report`. Recording is off until `set_enabled(true)` and is thread safe.
+namespace startup_trace {
+
+void set_enabled(bool enabled);
+
+bool enabled();
+
+void record(std::string name, double milliseconds);
+
+// print every recorded span in the order they finished
+void report(std::ostream& out);
+
+// records the time between construction and destruction under `name`
+class scope {
+public:
+    explicit scope(std::string name);
+
+    ~scope();
+
+    scope(scope const&) = delete;
+    scope& operator=(scope const&) = delete;
+
+private:
+    std::string name;
+    std::chrono::steady_clock::time_point start;
+};
+
+} // namespace startup_trace
+
+#endif // STARTUP_TRACE_H
@@ -0,0 +1,197 @@
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstddef>
+
+// number of levels in a full mip chain down to 1x1
+constexpr int mip_level_count(int width, int height) {
+    int levels = 1;
+
+    for (int size = std::max(width, height); size > 1; size /= 2) {
+        ++levels;
+    }
+
+    return levels;
+}
+
+// size of `level` of a `size` texel wide image, never less than 1
+constexpr int mip_level_size(int size, int level) {
+    return std::max(size >> level, 1);
+}
+
+static_assert(mip_level_count(512, 512) == 10);
+static_assert(mip_level_count(640, 1) == 10);
+static_assert(mip_level_size(5, 2) == 1);
+
+// bytes per 4x4 block of a block-compressed `internal_format`, 0 if the
+// format is not one of the compressed formats in gl_ext.h
+int compressed_block_size(unsigned int internal_format);
+
+// bytes in a `width` x `height` level of a block-compressed format
+std::size_t compressed_level_size(unsigned int internal_format, int width, int height);
+
+// false for compressed formats the current context can't sample
+bool texture_format_supported(unsigned int internal_format);
+
+struct texture_sampler {
+    int wrap_s = GL_REPEAT;
+    int wrap_t = GL_REPEAT;
+    int min_filter = GL_LINEAR;
+    int mag_filter = GL_LINEAR;
+
+    bool operator==(texture_sampler const&) const = default;
+};
+
+// 2D texture whose levels are all allocated up front. With
+// ARB_texture_storage the storage is immutable (glTexStorage2D), otherwise
+// each level is specified once and GL_TEXTURE_MAX_LEVEL limits the chain,
+// so the driver never has to reallocate or revalidate it.
+class Texture2D {
+public:
+    unsigned int ID;
+
+    // allocate `levels` levels of `internal_format`, eg. GL_RGBA8, 0
+    // allocates the full chain
+    Texture2D(int width, int height, unsigned int internal_format, int levels = 0);
+
+    ~Texture2D();
+
+    Texture2D(Texture2D const&) = delete;
+    Texture2D& operator=(Texture2D const&) = delete;
+
+    Texture2D(Texture2D&& other) noexcept;
+    Texture2D& operator=(Texture2D&& other) noexcept;
+
+    // replace the whole of `level`, `pixels` is laid out as `pixel_format`
+    // and `type` with the current GL_UNPACK_ALIGNMENT
+    void upload(
+        int level,
+        unsigned int pixel_format,
+        unsigned int type,
+        void const *pixels
+    );
+
+    // replace a region of `level`
+    void upload(
+        int level,
+        int x,
+        int y,
+        int width,
+        int height,
+        unsigned int pixel_format,
+        unsigned int type,
+        void const *pixels
+    );
+
+    // replace the whole of `level` of a compressed texture with `size`
+    // bytes of blocks
+    void upload_compressed(int level, std::size_t size, void const *data);
+
+    // replace a block-aligned region of `level` of a compressed texture
+    void upload_compressed(
+        int level,
+        int x,
+        int y,
+        int width,
+        int height,
+        std::size_t size,
+        void const *data
+    );
+
+    // fill every level after the first from level 0, not needed when all
+    // levels were uploaded
+    void generate_mipmaps();
+
+    void set_sampler(texture_sampler const& sampler);
+
+    // bind to GL_TEXTURE0 + `unit`
+    void bind(int unit) const;
+
+    int width() const { return base_width; }
+
+    int height() const { return base_height; }
+
+    int levels() const { return level_count; }
+
+    unsigned int internal_format() const { return storage_format; }
+
+    // estimated video memory used by every level, drivers may pad further
+    std::size_t storage_size() const;
+
+    // true if storage is allocated with glTexStorage2D
+    static bool immutable_supported();
+
+private:
+    int base_width;
+    int base_height;
+    int level_count;
+    unsigned int storage_format;
+};
+
+// Array of same-sized 2D layers sampled through one sampler2DArray, so
+// objects using different images can be drawn without rebinding. Storage
+// is allocated up front like `Texture2D`, with glTexStorage3D when
+// available.
+class Texture2DArray {
+public:
+    unsigned int ID;
+
+    // allocate `layers` layers of `levels` levels, 0 allocates the full chain
+    Texture2DArray(
+        int width,
+        int height,
+        int layers,
+        unsigned int internal_format,
+        int levels = 0
+    );
+
+    ~Texture2DArray();
+
+    Texture2DArray(Texture2DArray const&) = delete;
+    Texture2DArray& operator=(Texture2DArray const&) = delete;
+
+    Texture2DArray(Texture2DArray&& other) noexcept;
+    Texture2DArray& operator=(Texture2DArray&& other) noexcept;
+
+    // replace the whole of `level` of `layer`
+    void upload(
+        int layer,
+        int level,
+        unsigned int pixel_format,
+        unsigned int type,
+        void const *pixels
+    );
+
+    // fill every level after the first of every layer
+    void generate_mipmaps();
+
+    void set_sampler(texture_sampler const& sampler);
+
+    // bind to GL_TEXTURE0 + `unit`
+    void bind(int unit) const;
+
+    int width() const { return base_width; }
+
+    int height() const { return base_height; }
+
+    int layers() const { return layer_count; }
+
+    int levels() const { return level_count; }
+
+    unsigned int internal_format() const { return storage_format; }
+
+    // true if storage is allocated with glTexStorage3D
+    static bool immutable_supported();
+
+private:
+    int base_width;
+    int base_height;
+    int layer_count;
+    int level_count;
+    unsigned int storage_format;
+};
+
+#endif // TEXTURE_H
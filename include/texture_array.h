@@ -0,0 +1,60 @@
+#ifndef TEXTURE_ARRAY_H
+#define TEXTURE_ARRAY_H
+
+#include <string>
+#include <vector>
+
+#include <image_ops.h>
+#include <texture.h>
+
+// layer of an array built by `TextureArrayBuilder`, `array` indexes the
+// arrays returned by `build`
+struct texture_layer {
+    int array = -1;
+    int layer = -1;
+};
+
+// Packs images into as few `Texture2DArray`s as possible, one per distinct
+// image size and GL_MAX_ARRAY_TEXTURE_LAYERS layers, so a draw can pick its
+// image with a layer index instead of a texture bind. Every image is
+// expanded to RGBA8 (SRGB8_ALPHA8 when `srgb`) so any two images of the
+// same size fit the same array.
+//
+// `add` only reads the image header, so layers are known before anything
+// is decoded. `build` goes through the arrays one at a time, decoding their
+// images in parallel from shared mappings, filtering the mip chains on the
+// CPU and uploading them, so only one array is held in memory at once.
+class TextureArrayBuilder {
+public:
+    // needs a current context to query the layer limit
+    explicit TextureArrayBuilder(bool srgb = false);
+
+    // queue the image at `path`, returns an invalid layer if its header
+    // can't be read. `expand_rgba` is implied
+    texture_layer add(std::string path, image_options options = {});
+
+    // decode the queued images on up to `threads` threads, 0 uses every
+    // hardware thread. Images that fail to decode are reported on stderr
+    // and leave their layer white
+    std::vector<Texture2DArray> build(unsigned int threads = 0) const;
+
+    int array_count() const { return static_cast<int>(widths.size()); }
+
+private:
+    struct queued_image {
+        std::string path;
+        image_options options;
+        texture_layer layer;
+    };
+
+    bool srgb;
+    int max_layers;
+    std::vector<queued_image> images;
+
+    // size and layer count of each array, indexed by `texture_layer::array`
+    std::vector<int> widths;
+    std::vector<int> heights;
+    std::vector<int> layer_counts;
+};
+
+#endif // TEXTURE_ARRAY_H
@@ -0,0 +1,132 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <texture.h>
+#include <texture_loader.h>
+
+// index into a cache's entries, returned by `TextureCache::acquire`
+struct cached_texture {
+    int index = -1;
+};
+
+// counters since the cache was created
+struct texture_cache_stats {
+    // `acquire` calls answered by an existing entry
+    std::size_t hits = 0;
+    // `acquire` calls that had to load a file
+    std::size_t loads = 0;
+    // textures unloaded to stay within the budget
+    std::size_t evictions = 0;
+};
+
+// Reference-counted textures shared by everything that asks for them.
+// Acquiring the same path, options and sampler again returns the same entry.
+// Files with identical contents are decoded once by the `TextureLoader`
+// underneath and share one texture, each distinct sampler is a sampler
+// object bound next to it, so one image can be sampled several ways
+// without being stored twice.
+//
+// Released textures stay resident so acquiring them again is free. Once
+// the estimated video memory of every resident texture exceeds the budget
+// the least recently bound ones nobody references are unloaded in
+// `update`, except those a load still in flight was found to share.
+// Entries are found by path and the resident total is kept by the loader,
+// so neither grows with the number of textures until the budget is
+// exceeded.
+class TextureCache {
+public:
+    // `threads` decode workers and `mips`, see `TextureLoader`
+    explicit TextureCache(
+        std::size_t vram_budget,
+        unsigned int threads = 0,
+        mip_generation mips = mip_generation::gpu
+    );
+
+    ~TextureCache();
+
+    TextureCache(TextureCache const&) = delete;
+    TextureCache& operator=(TextureCache const&) = delete;
+
+    // take a reference to the texture at `path` sampled with `sampler`,
+    // loading it in the background if it isn't resident
+    cached_texture acquire(
+        std::string const& path,
+        texture_sampler const& sampler = {},
+        image_options const& options = {}
+    );
+
+    // drop a reference taken by `acquire`, the texture becomes evictable
+    // once every entry sharing it is released
+    void release(cached_texture texture);
+
+    // upload loaded textures within `byte_budget` and evict down to the
+    // video memory budget, returns the number of textures still loading
+    std::size_t update(std::size_t byte_budget);
+
+    // bind the texture and its sampler to GL_TEXTURE0 + `unit` and mark it
+    // as recently used
+    void bind(cached_texture texture, int unit);
+
+    // texture object to bind for `texture`, the loader's placeholder until
+    // it is ready
+    unsigned int texture(cached_texture texture) const;
+
+    // sampler object `texture` is sampled through
+    unsigned int sampler(cached_texture texture) const;
+
+    bool ready(cached_texture texture) const;
+
+    // estimated video memory of every resident texture
+    std::size_t resident_size() const;
+
+    std::size_t budget() const { return vram_budget; }
+
+    void set_budget(std::size_t bytes) { vram_budget = bytes; }
+
+    texture_cache_stats stats() const { return counters; }
+
+private:
+    struct entry {
+        std::string path;
+        image_options options;
+        // index into `sampler_params` and `sampler_ids`
+        int sampler;
+        // invalid once the texture was evicted, reloaded on the next acquire
+        texture_handle source;
+        int refs;
+    };
+
+    TextureLoader loader;
+    std::size_t vram_budget;
+    std::uint64_t frame = 0;
+    texture_cache_stats counters;
+
+    std::vector<entry> entries;
+
+    // indices into `entries` of every options and sampler variant of a path
+    std::unordered_map<std::string, std::vector<int>> path_entries;
+
+    // one sampler object per distinct `texture_sampler`
+    std::vector<texture_sampler> sampler_params;
+    std::vector<unsigned int> sampler_ids;
+
+    // frame each texture was last acquired or bound and the references
+    // held on it, indexed by the owning loader handle. The references are
+    // gathered when evicting
+    std::vector<std::uint64_t> last_used;
+    std::vector<int> owner_refs;
+
+    int sampler_index(texture_sampler const& sampler);
+
+    void touch(entry const& current);
+
+    void evict();
+};
+
+#endif // TEXTURE_CACHE_H
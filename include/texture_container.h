@@ -0,0 +1,89 @@
+#ifndef TEXTURE_CONTAINER_H
+#define TEXTURE_CONTAINER_H
+
+#include <mapped_file.h>
+#include <texture.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+// GPU-ready texture file written by `learn_opengl_bake`, modelled on KTX2:
+// a fixed header, an index of every mip level and the level data, each
+// level aligned so it can be uploaded straight from a mapping of the file.
+//
+//     container_header
+//     container_level_index[level_count]    level 0 first
+//     level data, 16 byte aligned
+enum container_flags : std::uint32_t {
+    CONTAINER_SRGB = 1,
+    CONTAINER_COMPRESSED = 2,
+};
+
+struct container_header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint32_t level_count;
+    // sized GL internal format, eg. GL_SRGB8_ALPHA8
+    std::uint32_t internal_format;
+    // client format and type of the level data, 0 when compressed
+    std::uint32_t pixel_format;
+    std::uint32_t type;
+    std::uint32_t flags;
+    std::uint32_t reserved[2];
+};
+
+struct container_level_index {
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+// file extension the texture loader recognises as a container
+inline constexpr char const *texture_container_extension = ".tex";
+
+// write `levels`, level 0 first, under `header`; the magic, version and
+// level count are filled in. Returns false on I/O errors
+bool write_texture_container(
+    std::filesystem::path const& path,
+    container_header header,
+    std::vector<std::vector<unsigned char>> const& levels
+);
+
+// memory mapped texture container, level data points into the mapping
+class TextureContainer {
+public:
+    // errors are reported on stderr and leave the container not `ok`.
+    // `access` is how the levels will be read, see `mapping_cache::open`
+    explicit TextureContainer(
+        std::filesystem::path const& path,
+        file_access access = file_access::sequential
+    );
+
+    bool ok() const { return valid; }
+
+    container_header const& header() const { return info; }
+
+    int levels() const { return static_cast<int>(info.level_count); }
+
+    unsigned char const *level_data(int level) const;
+
+    std::size_t level_size(int level) const;
+
+    // texture holding every level of the container
+    Texture2D upload() const;
+
+private:
+    // shared with any other holder of the same file, see `mapping_cache`
+    std::shared_ptr<MappedFile const> file;
+    container_header info = {};
+    bool valid = false;
+
+    // read from the mapping on demand so the container stays movable
+    container_level_index level_entry(int level) const;
+};
+
+#endif // TEXTURE_CONTAINER_H
@@ -0,0 +1,186 @@
+#ifndef TEXTURE_LOADER_H
+#define TEXTURE_LOADER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <image_ops.h>
+#include <mipmap.h>
+#include <texture.h>
+#include <texture_container.h>
+#include <upload_ring.h>
+
+// where the mip levels of decoded images are generated, `cpu` filters them
+// on the decode workers and uploads them like level 0, which is faster than
+// glGenerateMipmap under software GL
+enum class mip_generation {
+    gpu,
+    cpu,
+};
+
+// index into a loader's textures, returned by `TextureLoader::load`
+struct texture_handle {
+    int index = -1;
+};
+
+// Loads 2D textures without stalling the render loop. Images are decoded
+// by a pool of worker threads and handed back to the GL thread through a
+// lock-free queue. `update`, called once per frame from the thread owning
+// the context, uploads them a few rows at a time within a byte budget.
+// Until a texture is complete its handle resolves to a 1x1 white
+// placeholder, so callers can bind it unconditionally.
+//
+// With ARB_buffer_storage the workers copy decoded texels straight into a
+// persistently mapped `UploadRing` and the GL thread uploads from the
+// buffer, otherwise uploads read from client memory.
+//
+// Paths ending in `texture_container_extension` are baked containers, they
+// are mapped instead of decoded and every stored level is uploaded as is.
+//
+// Decoded images are transformed per load as `image_options` asks, baked
+// containers are uploaded as stored.
+//
+// Workers hash the file contents before decoding. A file whose contents
+// (and options) match a texture that is loaded or in flight is not decoded
+// again, its handle becomes an alias sharing the first one's texture.
+class TextureLoader {
+public:
+    // `threads` decode workers, 0 uses one less than the hardware threads
+    explicit TextureLoader(
+        unsigned int threads = 0,
+        mip_generation mips = mip_generation::gpu
+    );
+
+    ~TextureLoader();
+
+    TextureLoader(TextureLoader const&) = delete;
+    TextureLoader& operator=(TextureLoader const&) = delete;
+
+    // queue `path` for decoding and return immediately
+    texture_handle load(std::string path, image_options options = {});
+
+    // upload decoded images, spending at most `byte_budget` bytes of texel
+    // data but always at least one row, returns the number of textures that
+    // are still loading
+    std::size_t update(std::size_t byte_budget);
+
+    // texture to bind for `handle`, the placeholder until it is ready or if
+    // it failed to load
+    unsigned int texture(texture_handle handle) const;
+
+    bool ready(texture_handle handle) const;
+
+    // handle owning the texture `handle` resolves to, `handle` itself unless
+    // its contents were found to duplicate another load
+    texture_handle owner(texture_handle handle) const;
+
+    // estimated video memory of the texture behind `handle`, 0 until ready
+    std::size_t resident_size(texture_handle handle) const;
+
+    // estimated video memory of every texture, kept up to date as textures
+    // are uploaded and unloaded
+    std::size_t resident_size() const { return resident_bytes; }
+
+    // destroy the texture behind `handle` and every alias of it, they
+    // resolve to the placeholder afterwards and a new `load` decodes the
+    // file again. Returns false and keeps the texture if a load still in
+    // flight was found to share it. Must not be called while the texture
+    // is still loading
+    bool unload(texture_handle handle);
+
+    // number of textures neither uploaded nor failed
+    std::size_t loading() const { return outstanding; }
+
+private:
+    struct decode_job {
+        int index;
+        std::string path;
+        image_options options;
+    };
+
+    // node of the intrusive stack the workers push decoded images onto,
+    // texels are in `pixels`, staged in `region` of the ring or in the
+    // levels of a mapped `container`. `expanded` replaces `pixels` once a
+    // three channel image is widened to RGBA. `mips` holds levels 1 and
+    // below when they are generated on the CPU. `alias` is the handle whose
+    // texture has the same `content`, or -1
+    struct decoded_image {
+        int index;
+        int alias;
+        std::uint64_t content;
+        unsigned char *pixels;
+        std::vector<unsigned char> expanded;
+        upload_region region;
+        std::optional<TextureContainer> container;
+        std::vector<mip_level> mips;
+        int width;
+        int height;
+        int channels;
+        decoded_image *next;
+    };
+
+    // image being uploaded by `update`, `row` of `level` is the next row to
+    // upload, storage is allocated with the first row
+    struct upload {
+        decoded_image *image;
+        std::optional<Texture2D> texture;
+        int level;
+        int row;
+    };
+
+    Texture2D placeholder;
+    std::optional<UploadRing> ring;
+    mip_generation mip_mode;
+
+    // indexed by `texture_handle::index`, empty until the upload completes
+    std::vector<std::string> paths;
+    std::vector<std::optional<Texture2D>> textures;
+    std::vector<int> owners;
+    std::size_t outstanding = 0;
+    std::size_t resident_bytes = 0;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<decode_job> jobs;
+    bool running = true;
+
+    // content hash of every texture loaded or in flight and the handle that
+    // owns it, guarded by `mutex`
+    std::vector<std::uint64_t> contents;
+    std::vector<int> content_owners;
+    // loads decoded as an alias of the owning handle but not yet resolved
+    // by `update`, guarded by `mutex`
+    std::unordered_map<int, int> pending_aliases;
+    std::vector<std::thread> workers;
+
+    // multi-producer stack, drained in one exchange by the GL thread
+    std::atomic<decoded_image *> decoded = nullptr;
+    std::deque<upload> uploads;
+
+    void run();
+
+    // decode `job` with stb_image into `image` on a worker
+    void decode(decode_job const& job, decoded_image& image);
+
+    // register `content` as owned by `index`, returns the existing owner of
+    // the same content or -1
+    int claim_content(std::uint64_t content, int index);
+
+    void forget_content(int index);
+
+    // same as `forget_content` with `mutex` already held
+    void erase_content(int index);
+
+    void finish(upload& current);
+};
+
+#endif // TEXTURE_LOADER_H
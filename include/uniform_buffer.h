@@ -0,0 +1,151 @@
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+
+// std140 base alignment and size rules, used to check that a C++ struct
+// matches the layout of a GLSL `layout (std140)` uniform block
+namespace std140 {
+
+constexpr std::size_t align_up(std::size_t offset, std::size_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+template <typename T>
+struct type_info;
+
+template <>
+struct type_info<float> {
+    static constexpr std::size_t alignment = 4;
+    static constexpr std::size_t size = 4;
+};
+
+template <>
+struct type_info<int> : type_info<float> {};
+
+template <>
+struct type_info<unsigned int> : type_info<float> {};
+
+template <>
+struct type_info<glm::vec2> {
+    static constexpr std::size_t alignment = 8;
+    static constexpr std::size_t size = 8;
+};
+
+template <>
+struct type_info<glm::vec3> {
+    static constexpr std::size_t alignment = 16;
+    static constexpr std::size_t size = 12;
+};
+
+template <>
+struct type_info<glm::vec4> {
+    static constexpr std::size_t alignment = 16;
+    static constexpr std::size_t size = 16;
+};
+
+// matrices are stored as arrays of column vectors padded to a vec4
+template <>
+struct type_info<glm::mat2> {
+    static constexpr std::size_t alignment = 16;
+    static constexpr std::size_t size = 2 * 16;
+};
+
+template <>
+struct type_info<glm::mat3> {
+    static constexpr std::size_t alignment = 16;
+    static constexpr std::size_t size = 3 * 16;
+};
+
+template <>
+struct type_info<glm::mat4> {
+    static constexpr std::size_t alignment = 16;
+    static constexpr std::size_t size = 4 * 16;
+};
+
+// array elements are padded to a vec4
+template <typename T, std::size_t N>
+struct type_info<std::array<T, N>> {
+    static constexpr std::size_t alignment = 16;
+    static constexpr std::size_t size = N * align_up(type_info<T>::size, 16);
+};
+
+// std140 offsets of a block whose members have the types `Ts...` in
+// declaration order, eg.
+//
+//     using frame_layout = std140::layout<glm::mat4, glm::mat4, float>;
+//     static_assert(offsetof(frame_data, time) == frame_layout::offset(2));
+template <typename... Ts>
+struct layout {
+    static constexpr std::size_t count = sizeof...(Ts);
+
+    static constexpr std::array<std::size_t, count + 1> offsets = [] {
+        auto result = std::array<std::size_t, count + 1>{};
+        std::size_t offset = 0;
+        std::size_t i = 0;
+
+        ((offset = align_up(offset, type_info<Ts>::alignment),
+          result[i++] = offset,
+          offset += type_info<Ts>::size),
+         ...);
+
+        result[count] = offset;
+        return result;
+    }();
+
+    static constexpr std::size_t offset(std::size_t member) { return offsets[member]; }
+
+    // blocks are padded to a multiple of a vec4
+    static constexpr std::size_t size = align_up(offsets[count], 16);
+};
+
+} // namespace std140
+
+// fixed binding points shared by every program, blocks are attached to
+// these with `Shader::bind_uniform_block`
+enum uniform_binding : unsigned int {
+    FRAME_BINDING = 0,
+    TEXTURE_HANDLES_BINDING = 1,
+};
+
+// owns a GL uniform buffer attached to a single binding point
+class UniformBuffer {
+public:
+    unsigned int ID;
+
+    UniformBuffer(std::size_t size, unsigned int binding);
+
+    ~UniformBuffer();
+
+    UniformBuffer(UniformBuffer const&) = delete;
+    UniformBuffer& operator=(UniformBuffer const&) = delete;
+
+    UniformBuffer(UniformBuffer&& other) noexcept;
+    UniformBuffer& operator=(UniformBuffer&& other) noexcept;
+
+    // upload `size` bytes starting at `offset` into the buffer
+    void update(void const *data, std::size_t size, std::size_t offset = 0) const;
+
+    template <typename T>
+    void update(T const& block) const {
+        update(&block, sizeof(T));
+    }
+
+    // re-attach the buffer to its binding point
+    void bind() const;
+
+    std::size_t size() const { return buffer_size; }
+
+    unsigned int binding() const { return binding_point; }
+
+private:
+    std::size_t buffer_size;
+    unsigned int binding_point;
+};
+
+#endif // UNIFORM_BUFFER_H
@@ -0,0 +1,85 @@
+#ifndef UPLOAD_RING_H
+#define UPLOAD_RING_H
+
+#include <glad/glad.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+// region of an `UploadRing` returned by `allocate`, `offset` is what is
+// passed as the pixel pointer while the ring is bound to
+// GL_PIXEL_UNPACK_BUFFER
+struct upload_region {
+    std::size_t offset = 0;
+    unsigned char *data = nullptr;
+    std::size_t size = 0;
+};
+
+// Pixel unpack buffer persistently mapped for the lifetime of the ring
+// (ARB_buffer_storage). Any thread can `allocate` a region and write texels
+// straight into it, the GL thread then uploads from the buffer offset with
+// glTexSubImage2D. Regions are recycled in allocation order once a fence
+// shows the GPU has finished reading them.
+class UploadRing {
+public:
+    unsigned int ID;
+
+    explicit UploadRing(std::size_t size);
+
+    ~UploadRing();
+
+    UploadRing(UploadRing const&) = delete;
+    UploadRing& operator=(UploadRing const&) = delete;
+
+    // true if the context can map a buffer persistently
+    static bool supported();
+
+    // reserve `size` bytes, thread safe, returns false if the ring doesn't
+    // have that much free space right now
+    bool allocate(std::size_t size, upload_region& region);
+
+    // mark `region` as read by commands issued on the GL thread, it is
+    // recycled after the next `fence` completes
+    void submit(upload_region const& region);
+
+    // insert a fence after every region submitted since the last call,
+    // meant to be called once per frame from the GL thread
+    void fence();
+
+    // recycle regions whose fence has signalled, never blocks
+    void reclaim();
+
+    std::size_t size() const { return capacity; }
+
+private:
+    struct allocation {
+        std::size_t offset;
+        // includes the padding skipped when the allocation wrapped
+        std::size_t size;
+        bool submitted;
+        // 0 until covered by a fence
+        std::uint64_t fence;
+    };
+
+    struct pending_fence {
+        GLsync sync;
+        std::uint64_t index;
+    };
+
+    std::size_t capacity;
+    unsigned char *mapped = nullptr;
+
+    std::mutex mutex;
+    std::size_t head = 0;
+    std::size_t used = 0;
+    std::deque<allocation> allocations;
+
+    // GL thread only
+    std::deque<pending_fence> fences;
+    std::uint64_t next_fence = 1;
+    std::uint64_t completed_fence = 0;
+};
+
+#endif // UPLOAD_RING_H
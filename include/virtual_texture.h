@@ -0,0 +1,225 @@
+#ifndef VIRTUAL_TEXTURE_H
+#define VIRTUAL_TEXTURE_H
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <shader.h>
+#include <texture.h>
+#include <texture_container.h>
+
+// tile of a virtual texture, `x` and `y` count tiles across `level`
+struct virtual_page {
+    int x;
+    int y;
+    int level;
+};
+
+// counters since the virtual texture was created
+struct virtual_texture_stats {
+    // missing pages queued for decoding from feedback
+    std::size_t requests = 0;
+    // tiles copied into the atlas
+    std::size_t uploads = 0;
+    // tiles evicted to make room for another
+    std::size_t evictions = 0;
+};
+
+// Streams the mip levels of a baked texture container (see
+// texture_container.h) through a fixed-size tile atlas, so an image of any
+// size is drawn with the same video memory. Every level is split into
+// square pages, a page table texture maps each page to the atlas slot
+// holding it or, while it is missing, to the closest coarser ancestor that
+// is resident. The coarsest level is loaded up front and never evicted.
+// Tiles are read in no particular order, so the container is mapped for
+// random access.
+//
+// The shader side is shaders/virtual_texture.glsl. Pages are requested
+// through `VirtualTextureFeedback`: a low resolution pass writes the page
+// every pixel wants, and `request` queues the missing ones for the worker
+// threads, which copy the tile and its border out of the mapped container.
+// `update` uploads finished tiles into free or least recently used slots.
+// Once every slot was sampled this frame, the tile the fewest feedback
+// texels sample gives way to one more texels need, so a full atlas keeps
+// refining the pages that cover most of the screen.
+//
+// Works on any GL 3.3 context, the atlas takes the place of
+// ARB_sparse_texture. Tiles carry a 4 texel border so bilinear filtering
+// doesn't bleed across slots, which also keeps block-compressed tiles
+// block aligned; filtering between mip levels is not supported.
+class VirtualTexture {
+public:
+    // `atlas_tiles` x `atlas_tiles` slots of `tile_size` texels, which must
+    // be a multiple of 4, and `threads` tile workers. Errors are reported on
+    // stderr and leave the texture not `ok`
+    explicit VirtualTexture(
+        std::filesystem::path const& path,
+        int atlas_tiles = 16,
+        int tile_size = 128,
+        unsigned int threads = 1
+    );
+
+    ~VirtualTexture();
+
+    VirtualTexture(VirtualTexture const&) = delete;
+    VirtualTexture& operator=(VirtualTexture const&) = delete;
+
+    bool ok() const { return valid; }
+
+    // mark the pages in `count` feedback texels as used and queue the
+    // missing ones, requests still queued from earlier feedback are dropped
+    void request(unsigned char const *feedback, std::size_t count);
+
+    // upload at most `max_tiles` finished tiles and refresh the page table,
+    // returns the number of tiles still queued or decoding
+    std::size_t update(int max_tiles);
+
+    // bind the atlas and page table to the units `shader` assigned them and
+    // set its virtual texture uniforms, the program must be in use.
+    // `lod_bias` is added to the level the shader picks, the feedback pass
+    // uses it to make up for its lower resolution
+    void bind(Shader const& shader, float lod_bias = 0.0f) const;
+
+    int width() const { return static_cast<int>(container.header().width); }
+
+    int height() const { return static_cast<int>(container.header().height); }
+
+    // levels split into pages, the last one is always resident
+    int page_levels() const { return static_cast<int>(pages_x.size()); }
+
+    // slots currently holding a tile
+    int resident_tiles() const;
+
+    virtual_texture_stats stats() const { return counters; }
+
+private:
+    struct tile_slot {
+        // page held by the slot, `level` is -1 if it is free
+        virtual_page page;
+        std::uint64_t used;
+        bool pinned;
+        // feedback texels of the last request sampling this tile
+        int weight;
+    };
+
+    struct tile_request {
+        virtual_page page;
+        // feedback texels that will sample the tile once it is resident
+        int weight;
+    };
+
+    struct decoded_tile {
+        virtual_page page;
+        int weight;
+        std::vector<unsigned char> texels;
+    };
+
+    TextureContainer container;
+    bool valid = false;
+    int tile;
+    int atlas_slots;
+    // texels per row of a tile including both borders
+    int slot_size;
+    // 1 for plain texels, 4 for block-compressed levels
+    int unit_size = 1;
+    int unit_bytes = 4;
+
+    std::optional<Texture2D> atlas;
+    std::optional<Texture2D> page_table;
+
+    // pages across and down each level, slot index of every page or -1 and
+    // whether it is queued, indexed by level then `y * pages_x + x`
+    std::vector<int> pages_x;
+    std::vector<int> pages_y;
+    std::vector<std::vector<int>> page_slots;
+    std::vector<std::vector<unsigned char>> page_pending;
+
+    std::vector<tile_slot> slots;
+    std::uint64_t frame = 0;
+    bool table_dirty = false;
+    virtual_texture_stats counters;
+
+    // page table texels, RGBA8UI holding the slot, the level the slot holds
+    // and 255 once mapped, indexed by level
+    std::vector<std::vector<std::array<unsigned char, 4>>> table;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    // highest weight first
+    std::deque<tile_request> jobs;
+    std::deque<decoded_tile> finished;
+    std::size_t in_flight = 0;
+    bool running = true;
+    std::vector<std::thread> workers;
+
+    void run();
+
+    // copy the tile of `page` and its border out of the container
+    void read_tile(virtual_page page, std::vector<unsigned char>& texels) const;
+
+    // place a tile in a free or least recently used slot, or in place of
+    // the tile fewer feedback texels sample, returns false if there is none
+    bool place(decoded_tile const& tile);
+
+    void upload_tile(int slot, std::vector<unsigned char> const& texels);
+
+    // page of the next coarser level covering the centre of `page`
+    virtual_page parent(virtual_page page) const;
+
+    // mark `page` and its resident ancestors as used this frame
+    void touch(virtual_page page);
+
+    void rebuild_table();
+};
+
+// Low resolution render target the feedback pass of a virtual texture
+// draws into. The texels are read back through a small ring of pixel
+// buffers fenced per frame, so `resolve` never waits on the GPU; requests
+// arrive a couple of frames after the pass that made them.
+class VirtualTextureFeedback {
+public:
+    VirtualTextureFeedback(int width, int height);
+
+    ~VirtualTextureFeedback();
+
+    VirtualTextureFeedback(VirtualTextureFeedback const&) = delete;
+    VirtualTextureFeedback& operator=(VirtualTextureFeedback const&) = delete;
+
+    // bind and clear the feedback target, remembering the viewport
+    void begin();
+
+    // queue the readback of the pass and restore the default framebuffer
+    void end();
+
+    // pass the oldest finished readback to `texture`, returns false if none
+    // has completed yet
+    bool resolve(VirtualTexture& texture);
+
+    int width() const { return target_width; }
+
+    int height() const { return target_height; }
+
+private:
+    static constexpr int readback_count = 3;
+
+    unsigned int framebuffer = 0;
+    unsigned int colour = 0;
+    std::array<unsigned int, readback_count> buffers = {};
+    std::array<GLsync, readback_count> fences = {};
+    int target_width;
+    int target_height;
+    // next buffer `end` writes and oldest one `resolve` reads
+    int write_index = 0;
+    int read_index = 0;
+    std::array<int, 4> viewport = {};
+};
+
+#endif // VIRTUAL_TEXTURE_H
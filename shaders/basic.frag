@@ -1,7 +1,32 @@
 #version 330 core
 
+#ifdef BINDLESS
+#extension GL_ARB_bindless_texture : require
+
+// two handles per element, see `BindlessTextureTable`
+layout (std140) uniform texture_handles {
+    uvec4 handles[BINDLESS_CAPACITY / 2];
+};
+
+flat in vec2 layers;
+
+uvec2 texture_handle(float slot) {
+    uvec4 pair = handles[int(slot) / 2];
+    return int(slot) % 2 == 0 ? pair.xy : pair.zw;
+}
+#elif defined(VIRTUAL_TEXTURE)
+// stands in for tex0
+#include "virtual_texture.glsl"
+
+uniform sampler2D tex1;
+#elif defined(TEXTURE_ARRAY)
+uniform sampler2DArray textures;
+
+flat in vec2 layers;
+#else
 uniform sampler2D tex0;
 uniform sampler2D tex1;
+#endif
 
 in vec3 colour;
 in vec2 tex_coord;
@@ -9,6 +34,26 @@ in vec2 tex_coord;
 out vec4 frag_colour;
 
 void main() {
+#ifdef WIREFRAME
+    frag_colour = vec4(colour, 1.0);
+#elif defined(VIRTUAL_TEXTURE_FEEDBACK)
+    frag_colour = virtual_texture_feedback(tex_coord);
+#elif defined(VIRTUAL_TEXTURE)
+    frag_colour = mix(virtual_texture(tex_coord), texture(tex1, tex_coord), 0.2);
+#elif defined(BINDLESS)
+    frag_colour = mix(
+        texture(sampler2D(texture_handle(layers.x)), tex_coord),
+        texture(sampler2D(texture_handle(layers.y)), tex_coord),
+        0.2
+    );
+#elif defined(TEXTURE_ARRAY)
+    frag_colour = mix(
+        texture(textures, vec3(tex_coord, layers.x)),
+        texture(textures, vec3(tex_coord, layers.y)),
+        0.2
+    );
+#else
     frag_colour = mix(texture(tex0, tex_coord), texture(tex1, tex_coord), 0.2);
+#endif
 }
 
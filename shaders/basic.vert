@@ -4,13 +4,35 @@ layout (location = 0) in vec3 pos;
 layout (location = 1) in vec3 in_colour;
 layout (location = 2) in vec2 in_tex_coord;
 
+#if defined(TEXTURE_ARRAY) || defined(BINDLESS)
+#define INSTANCED
+#endif
+
+#ifdef INSTANCED
+// per instance, the layers of `textures` used as tex0 and tex1, or their
+// slots in the handle table in the BINDLESS variant
+layout (location = 3) in vec2 in_layers;
+layout (location = 4) in mat4 instance_transform;
+
+flat out vec2 layers;
+#endif
+
 out vec3 colour;
 out vec2 tex_coord;
 
+#include "frame.glsl"
+
+#ifndef INSTANCED
 uniform mat4 transform;
+#endif
 
 void main() {
-    gl_Position = transform * vec4(pos, 1.0);
+#ifdef INSTANCED
+    gl_Position = projection * view * instance_transform * vec4(pos, 1.0);
+    layers = in_layers;
+#else
+    gl_Position = projection * view * transform * vec4(pos, 1.0);
+#endif
     colour = in_colour;
     tex_coord = in_tex_coord;
 }
@@ -0,0 +1,5 @@
+// per-frame data shared by every program, mirrored by frame_data in main.cxx
+layout (std140) uniform frame {
+    mat4 view;
+    mat4 projection;
+};
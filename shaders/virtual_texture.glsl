@@ -0,0 +1,69 @@
+// sampling side of `VirtualTexture`, its uniforms are set by
+// `VirtualTexture::bind`
+uniform sampler2D vt_atlas;
+uniform usampler2D vt_page_table;
+
+// level 0 width and height, tile size and tile border in texels
+uniform vec4 vt_size;
+// atlas size in texels, page levels and the lod bias of the pass
+uniform vec4 vt_layout;
+
+vec2 vt_level_size(int level) {
+    return max(floor(vt_size.xy / exp2(float(level))), vec2(1.0));
+}
+
+// level the hardware would pick for `uv`, limited to the paged levels
+int vt_level(vec2 uv) {
+    vec2 dx = dFdx(uv * vt_size.xy);
+    vec2 dy = dFdy(uv * vt_size.xy);
+    float lod = 0.5 * log2(max(dot(dx, dx), dot(dy, dy))) + vt_layout.z;
+
+    return int(clamp(lod, 0.0, vt_layout.y - 1.0));
+}
+
+ivec2 vt_page(vec2 uv, int level) {
+    vec2 texel = uv * vt_level_size(level);
+    vec2 pages = ceil(vt_level_size(level) / vt_size.z);
+
+    return ivec2(clamp(floor(texel / vt_size.z), vec2(0.0), pages - 1.0));
+}
+
+vec4 virtual_texture(vec2 uv) {
+    uv = clamp(uv, 0.0, 1.0);
+
+    int level = vt_level(uv);
+    uvec4 entry = texelFetch(vt_page_table, vt_page(uv, level), level);
+
+    // while the page loads the entry holds a coarser ancestor, its level is
+    // in `entry.z`. The border absorbs rounding between the CPU's and this
+    // page lookup at tile edges
+    int resident = int(entry.z);
+    vec2 texel = uv * vt_level_size(resident);
+    vec2 offset = clamp(
+        texel - vec2(vt_page(uv, resident)) * vt_size.z,
+        vec2(0.5 - vt_size.w),
+        vec2(vt_size.z + vt_size.w - 0.5)
+    );
+    float slot_size = vt_size.z + 2.0 * vt_size.w;
+    vec2 atlas_texel = vec2(entry.xy) * slot_size + vt_size.w + offset;
+
+    return textureLod(vt_atlas, atlas_texel / vt_layout.x, 0.0);
+}
+
+// page `uv` needs encoded for `VirtualTexture::request`: the low bits of x
+// and y in red and green, their high bits in blue and the level plus one in
+// alpha
+vec4 virtual_texture_feedback(vec2 uv) {
+    uv = clamp(uv, 0.0, 1.0);
+
+    int level = vt_level(uv);
+    uvec2 page = uvec2(vt_page(uv, level));
+    uvec4 request = uvec4(
+        page.x & 255u,
+        page.y & 255u,
+        (page.x >> 8) | ((page.y >> 8) << 4),
+        uint(level) + 1u
+    );
+
+    return vec4(request) / 255.0;
+}
@@ -0,0 +1,122 @@
+#include <bindless_textures.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <gl_ext.h>
+
+namespace {
+
+// std140 pads array elements to a uvec4, which holds two handles
+int even_capacity(int capacity) {
+    return std::max(capacity + capacity % 2, 2);
+}
+
+} // namespace
+
+BindlessTextureTable::BindlessTextureTable(int capacity, unsigned int binding)
+    : buffer(even_capacity(capacity) * sizeof(std::uint64_t), binding),
+      handles(even_capacity(capacity), 0), refs(even_capacity(capacity), 0) {
+    // free slots read as a null handle until something is added
+    dirty_end = static_cast<int>(handles.size());
+    update();
+}
+
+BindlessTextureTable::~BindlessTextureTable() {
+    release();
+}
+
+BindlessTextureTable::BindlessTextureTable(BindlessTextureTable&& other) noexcept
+    : buffer(std::move(other.buffer)), handles(std::exchange(other.handles, {})),
+      refs(std::exchange(other.refs, {})), dirty_begin(other.dirty_begin),
+      dirty_end(other.dirty_end) {}
+
+BindlessTextureTable& BindlessTextureTable::operator=(
+    BindlessTextureTable&& other
+) noexcept {
+    if (this != &other) {
+        release();
+        buffer = std::move(other.buffer);
+        handles = std::exchange(other.handles, {});
+        refs = std::exchange(other.refs, {});
+        dirty_begin = other.dirty_begin;
+        dirty_end = other.dirty_end;
+    }
+
+    return *this;
+}
+
+int BindlessTextureTable::add(unsigned int texture, unsigned int sampler) {
+    // the same texture and sampler always give the same handle, which must
+    // only be made resident once
+    auto const handle = sampler != 0 ? glGetTextureSamplerHandleARB(texture, sampler)
+                                     : glGetTextureHandleARB(texture);
+
+    if (handle == 0) {
+        return -1;
+    }
+
+    auto const found = std::find(handles.begin(), handles.end(), handle);
+
+    if (found != handles.end()) {
+        auto const slot = static_cast<int>(found - handles.begin());
+        ++refs[slot];
+        return slot;
+    }
+
+    auto const free = std::find(handles.begin(), handles.end(), std::uint64_t{0});
+
+    if (free == handles.end()) {
+        return -1;
+    }
+
+    auto const slot = static_cast<int>(free - handles.begin());
+    glMakeTextureHandleResidentARB(handle);
+    handles[slot] = handle;
+    refs[slot] = 1;
+
+    dirty_begin = dirty_begin < dirty_end ? std::min(dirty_begin, slot) : slot;
+    dirty_end = std::max(dirty_end, slot + 1);
+    return slot;
+}
+
+void BindlessTextureTable::remove(int slot) {
+    if (slot < 0 || handles[slot] == 0 || --refs[slot] > 0) {
+        return;
+    }
+
+    glMakeTextureHandleNonResidentARB(handles[slot]);
+    handles[slot] = 0;
+
+    dirty_begin = dirty_begin < dirty_end ? std::min(dirty_begin, slot) : slot;
+    dirty_end = std::max(dirty_end, slot + 1);
+}
+
+void BindlessTextureTable::update() {
+    if (dirty_begin >= dirty_end) {
+        return;
+    }
+
+    buffer.update(
+        handles.data() + dirty_begin,
+        (dirty_end - dirty_begin) * sizeof(std::uint64_t),
+        dirty_begin * sizeof(std::uint64_t)
+    );
+
+    dirty_begin = 0;
+    dirty_end = 0;
+}
+
+bool BindlessTextureTable::supported() {
+    return GLEXT_ARB_bindless_texture != 0;
+}
+
+void BindlessTextureTable::release() {
+    for (auto const handle : handles) {
+        if (handle != 0) {
+            glMakeTextureHandleNonResidentARB(handle);
+        }
+    }
+}
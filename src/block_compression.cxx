@@ -0,0 +1,902 @@
+#include <block_compression.h>
+
+#include <gl_ext.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <vector>
+
+// The encoders work on one 4x4 block at a time in float RGBA. Endpoints are
+// fitted along the bounding box diagonal or the principal axis of the block
+// and optionally refined by least squares against the chosen indices.
+// Blocks are independent, so whole rows of blocks are handed to threads.
+
+namespace {
+
+using block_pixels = std::array<std::array<float, 4>, 16>;
+
+void load_block(
+    unsigned char const *rgba,
+    int width,
+    int height,
+    int block_x,
+    int block_y,
+    block_pixels& pixels
+) {
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x) {
+            auto const sx = std::min(block_x * 4 + x, width - 1);
+            auto const sy = std::min(block_y * 4 + y, height - 1);
+            auto const *texel = rgba + (static_cast<std::size_t>(sy) * width + sx) * 4;
+
+            for (int c = 0; c < 4; ++c) {
+                pixels[y * 4 + x][c] = texel[c];
+            }
+        }
+    }
+}
+
+float squared_error(float const *a, float const *b, int channels) {
+    float error = 0.0f;
+
+    for (int c = 0; c < channels; ++c) {
+        error += (a[c] - b[c]) * (a[c] - b[c]);
+    }
+
+    return error;
+}
+
+float clamp_channel(float value) {
+    return std::clamp(value, 0.0f, 255.0f);
+}
+
+// endpoints spanning the block, along the bounding box diagonal or along
+// the axis of greatest variance found by power iteration
+void fit_endpoints(
+    block_pixels const& pixels,
+    int channels,
+    bool principal_axis,
+    float *lo,
+    float *hi
+) {
+    float mean[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float min[4] = {255.0f, 255.0f, 255.0f, 255.0f};
+    float max[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    for (auto const& pixel : pixels) {
+        for (int c = 0; c < channels; ++c) {
+            mean[c] += pixel[c] / 16.0f;
+            min[c] = std::min(min[c], pixel[c]);
+            max[c] = std::max(max[c], pixel[c]);
+        }
+    }
+
+    if (!principal_axis) {
+        std::copy(min, min + 4, lo);
+        std::copy(max, max + 4, hi);
+        return;
+    }
+
+    float covariance[4][4] = {};
+
+    for (auto const& pixel : pixels) {
+        for (int i = 0; i < channels; ++i) {
+            for (int j = 0; j < channels; ++j) {
+                covariance[i][j] += (pixel[i] - mean[i]) * (pixel[j] - mean[j]);
+            }
+        }
+    }
+
+    float axis[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    for (int c = 0; c < channels; ++c) {
+        axis[c] = max[c] - min[c];
+    }
+
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        float next[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        float length = 0.0f;
+
+        for (int i = 0; i < channels; ++i) {
+            for (int j = 0; j < channels; ++j) {
+                next[i] += covariance[i][j] * axis[j];
+            }
+
+            length += next[i] * next[i];
+        }
+
+        if (length < 1e-12f) {
+            break;
+        }
+
+        for (int c = 0; c < channels; ++c) {
+            axis[c] = next[c] / std::sqrt(length);
+        }
+    }
+
+    float axis_length = 0.0f;
+
+    for (int c = 0; c < channels; ++c) {
+        axis_length += axis[c] * axis[c];
+    }
+
+    // a flat block, every pixel is the mean
+    if (axis_length < 1e-12f) {
+        std::copy(mean, mean + 4, lo);
+        std::copy(mean, mean + 4, hi);
+        return;
+    }
+
+    auto t_min = std::numeric_limits<float>::max();
+    auto t_max = std::numeric_limits<float>::lowest();
+
+    for (auto const& pixel : pixels) {
+        float t = 0.0f;
+
+        for (int c = 0; c < channels; ++c) {
+            t += (pixel[c] - mean[c]) * axis[c];
+        }
+
+        t_min = std::min(t_min, t / axis_length);
+        t_max = std::max(t_max, t / axis_length);
+    }
+
+    for (int c = 0; c < 4; ++c) {
+        lo[c] = c < channels ? clamp_channel(mean[c] + t_min * axis[c]) : 255.0f;
+        hi[c] = c < channels ? clamp_channel(mean[c] + t_max * axis[c]) : 255.0f;
+    }
+}
+
+// least squares endpoints for pixels interpolated `weights[i]` of the way
+// from `lo` to `hi`, returns false if the system is singular
+bool refine_endpoints(
+    block_pixels const& pixels,
+    int channels,
+    float const *weights,
+    float *lo,
+    float *hi
+) {
+    float a = 0.0f;
+    float b = 0.0f;
+    float c = 0.0f;
+    float x[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float y[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    for (int i = 0; i < 16; ++i) {
+        auto const w = weights[i];
+
+        a += (1.0f - w) * (1.0f - w);
+        b += (1.0f - w) * w;
+        c += w * w;
+
+        for (int ch = 0; ch < channels; ++ch) {
+            x[ch] += (1.0f - w) * pixels[i][ch];
+            y[ch] += w * pixels[i][ch];
+        }
+    }
+
+    auto const determinant = a * c - b * b;
+
+    if (std::fabs(determinant) < 1e-6f) {
+        return false;
+    }
+
+    for (int ch = 0; ch < channels; ++ch) {
+        lo[ch] = clamp_channel((c * x[ch] - b * y[ch]) / determinant);
+        hi[ch] = clamp_channel((a * y[ch] - b * x[ch]) / determinant);
+    }
+
+    return true;
+}
+
+int refinement_passes(compression_quality quality) {
+    switch (quality) {
+        case compression_quality::fast:
+            return 0;
+        case compression_quality::normal:
+            return 1;
+        default:
+            return 4;
+    }
+}
+
+// ---- BC1 ----
+
+std::uint16_t pack_565(float const *colour) {
+    auto const r = static_cast<int>(std::lround(colour[0] * 31.0f / 255.0f));
+    auto const g = static_cast<int>(std::lround(colour[1] * 63.0f / 255.0f));
+    auto const b = static_cast<int>(std::lround(colour[2] * 31.0f / 255.0f));
+    return static_cast<std::uint16_t>(r << 11 | g << 5 | b);
+}
+
+void unpack_565(std::uint16_t packed, float *colour) {
+    auto const r = packed >> 11 & 31;
+    auto const g = packed >> 5 & 63;
+    auto const b = packed & 31;
+
+    colour[0] = static_cast<float>(r << 3 | r >> 2);
+    colour[1] = static_cast<float>(g << 2 | g >> 4);
+    colour[2] = static_cast<float>(b << 3 | b >> 2);
+    colour[3] = 255.0f;
+}
+
+// fraction of the way from colour 0 to colour 1 of each palette entry
+constexpr float bc1_weights[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+
+// nearest entry of the four colour palette for every pixel, returns the
+// total squared error
+float bc1_indices(
+    block_pixels const& pixels,
+    std::uint16_t c0,
+    std::uint16_t c1,
+    unsigned char *indices
+) {
+    float palette[4][4];
+    unpack_565(c0, palette[0]);
+    unpack_565(c1, palette[1]);
+
+    for (int c = 0; c < 3; ++c) {
+        palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+        palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+    }
+
+    float total = 0.0f;
+
+    for (int i = 0; i < 16; ++i) {
+        auto best = std::numeric_limits<float>::max();
+
+        for (int entry = 0; entry < 4; ++entry) {
+            auto const error = squared_error(pixels[i].data(), palette[entry], 3);
+
+            if (error < best) {
+                best = error;
+                indices[i] = static_cast<unsigned char>(entry);
+            }
+        }
+
+        total += best;
+    }
+
+    return total;
+}
+
+void encode_bc1(
+    block_pixels const& pixels,
+    compression_quality quality,
+    unsigned char *out
+) {
+    float lo[4];
+    float hi[4];
+    fit_endpoints(pixels, 3, quality != compression_quality::fast, lo, hi);
+
+    unsigned char indices[16];
+    auto c0 = pack_565(lo);
+    auto c1 = pack_565(hi);
+    auto error = bc1_indices(pixels, c0, c1, indices);
+
+    for (int pass = 0; pass < refinement_passes(quality); ++pass) {
+        float weights[16];
+
+        for (int i = 0; i < 16; ++i) {
+            weights[i] = bc1_weights[indices[i]];
+        }
+
+        if (!refine_endpoints(pixels, 3, weights, lo, hi)) {
+            break;
+        }
+
+        unsigned char refined[16];
+        auto const r0 = pack_565(lo);
+        auto const r1 = pack_565(hi);
+        auto const refined_error = bc1_indices(pixels, r0, r1, refined);
+
+        if (refined_error >= error) {
+            break;
+        }
+
+        c0 = r0;
+        c1 = r1;
+        error = refined_error;
+        std::copy(refined, refined + 16, indices);
+    }
+
+    // colour 0 must be the larger value to select the four colour mode
+    if (c0 < c1) {
+        std::swap(c0, c1);
+
+        for (auto& index : indices) {
+            index = static_cast<unsigned char>(index ^ 1);
+        }
+    } else if (c0 == c1) {
+        std::fill(indices, indices + 16, 0);
+    }
+
+    std::uint32_t bits = 0;
+
+    for (int i = 0; i < 16; ++i) {
+        bits |= static_cast<std::uint32_t>(indices[i]) << (2 * i);
+    }
+
+    out[0] = static_cast<unsigned char>(c0 & 0xFF);
+    out[1] = static_cast<unsigned char>(c0 >> 8);
+    out[2] = static_cast<unsigned char>(c1 & 0xFF);
+    out[3] = static_cast<unsigned char>(c1 >> 8);
+
+    for (int i = 0; i < 4; ++i) {
+        out[4 + i] = static_cast<unsigned char>(bits >> (8 * i));
+    }
+}
+
+// ---- BC3 ----
+
+void encode_bc3_alpha(block_pixels const& pixels, unsigned char *out) {
+    int a_min = 255;
+    int a_max = 0;
+
+    for (auto const& pixel : pixels) {
+        a_min = std::min(a_min, static_cast<int>(std::lround(pixel[3])));
+        a_max = std::max(a_max, static_cast<int>(std::lround(pixel[3])));
+    }
+
+    out[0] = static_cast<unsigned char>(a_max);
+    out[1] = static_cast<unsigned char>(a_min);
+
+    // with alpha 0 > alpha 1 the palette interpolates six values between them
+    float palette[8] = {static_cast<float>(a_max), static_cast<float>(a_min)};
+
+    for (int i = 2; i < 8; ++i) {
+        palette[i] = static_cast<float>((8 - i) * a_max + (i - 1) * a_min) / 7.0f;
+    }
+
+    std::uint64_t bits = 0;
+
+    for (int i = 0; i < 16 && a_max > a_min; ++i) {
+        int best_index = 0;
+        auto best = std::numeric_limits<float>::max();
+
+        for (int entry = 0; entry < 8; ++entry) {
+            auto const error = std::fabs(pixels[i][3] - palette[entry]);
+
+            if (error < best) {
+                best = error;
+                best_index = entry;
+            }
+        }
+
+        bits |= static_cast<std::uint64_t>(best_index) << (3 * i);
+    }
+
+    for (int i = 0; i < 6; ++i) {
+        out[2 + i] = static_cast<unsigned char>(bits >> (8 * i));
+    }
+}
+
+void encode_bc3(
+    block_pixels const& pixels,
+    compression_quality quality,
+    unsigned char *out
+) {
+    encode_bc3_alpha(pixels, out);
+    encode_bc1(pixels, quality, out + 8);
+}
+
+// ---- BC7 mode 6 ----
+
+constexpr int bc7_weights[16] = {
+    0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64,
+};
+
+// RGBA endpoint stored as 7 bits per channel plus a shared low bit
+struct bc7_endpoint {
+    int values[4];
+    int p;
+};
+
+bc7_endpoint quantize_bc7(float const *colour) {
+    auto best = bc7_endpoint{};
+    auto best_error = std::numeric_limits<float>::max();
+
+    for (int p = 0; p < 2; ++p) {
+        auto candidate = bc7_endpoint{{0, 0, 0, 0}, p};
+        float error = 0.0f;
+
+        for (int c = 0; c < 4; ++c) {
+            auto const value = static_cast<int>(std::lround((colour[c] - p) / 2.0f));
+            candidate.values[c] = std::clamp(value, 0, 127);
+
+            auto const expanded = static_cast<float>(candidate.values[c] << 1 | p);
+            error += (expanded - colour[c]) * (expanded - colour[c]);
+        }
+
+        if (error < best_error) {
+            best_error = error;
+            best = candidate;
+        }
+    }
+
+    return best;
+}
+
+float bc7_indices(
+    block_pixels const& pixels,
+    bc7_endpoint const& e0,
+    bc7_endpoint const& e1,
+    unsigned char *indices
+) {
+    float palette[16][4];
+
+    for (int entry = 0; entry < 16; ++entry) {
+        for (int c = 0; c < 4; ++c) {
+            auto const a = e0.values[c] << 1 | e0.p;
+            auto const b = e1.values[c] << 1 | e1.p;
+            auto const w = bc7_weights[entry];
+            palette[entry][c] = static_cast<float>(((64 - w) * a + w * b + 32) >> 6);
+        }
+    }
+
+    float total = 0.0f;
+
+    for (int i = 0; i < 16; ++i) {
+        auto best = std::numeric_limits<float>::max();
+
+        for (int entry = 0; entry < 16; ++entry) {
+            auto const error = squared_error(pixels[i].data(), palette[entry], 4);
+
+            if (error < best) {
+                best = error;
+                indices[i] = static_cast<unsigned char>(entry);
+            }
+        }
+
+        total += best;
+    }
+
+    return total;
+}
+
+// writes fields least significant bit first, `out` must be zeroed
+struct bit_writer {
+    unsigned char *out;
+    int position = 0;
+
+    void write(std::uint32_t value, int bits) {
+        for (int bit = 0; bit < bits; ++bit, ++position) {
+            if (value >> bit & 1) {
+                out[position / 8] |= static_cast<unsigned char>(1 << (position % 8));
+            }
+        }
+    }
+};
+
+void encode_bc7(
+    block_pixels const& pixels,
+    compression_quality quality,
+    unsigned char *out
+) {
+    float lo[4];
+    float hi[4];
+    fit_endpoints(pixels, 4, quality != compression_quality::fast, lo, hi);
+
+    unsigned char indices[16];
+    auto e0 = quantize_bc7(lo);
+    auto e1 = quantize_bc7(hi);
+    auto error = bc7_indices(pixels, e0, e1, indices);
+
+    for (int pass = 0; pass < refinement_passes(quality); ++pass) {
+        float weights[16];
+
+        for (int i = 0; i < 16; ++i) {
+            weights[i] = bc7_weights[indices[i]] / 64.0f;
+        }
+
+        if (!refine_endpoints(pixels, 4, weights, lo, hi)) {
+            break;
+        }
+
+        unsigned char refined[16];
+        auto const r0 = quantize_bc7(lo);
+        auto const r1 = quantize_bc7(hi);
+        auto const refined_error = bc7_indices(pixels, r0, r1, refined);
+
+        if (refined_error >= error) {
+            break;
+        }
+
+        e0 = r0;
+        e1 = r1;
+        error = refined_error;
+        std::copy(refined, refined + 16, indices);
+    }
+
+    // the top bit of the first index is implied 0, swap the endpoints so it is
+    if (indices[0] & 8) {
+        std::swap(e0, e1);
+
+        for (auto& index : indices) {
+            index = static_cast<unsigned char>(15 - index);
+        }
+    }
+
+    std::memset(out, 0, 16);
+    auto writer = bit_writer{out};
+
+    writer.write(1 << 6, 7);
+
+    for (int c = 0; c < 4; ++c) {
+        writer.write(static_cast<std::uint32_t>(e0.values[c]), 7);
+        writer.write(static_cast<std::uint32_t>(e1.values[c]), 7);
+    }
+
+    writer.write(static_cast<std::uint32_t>(e0.p), 1);
+    writer.write(static_cast<std::uint32_t>(e1.p), 1);
+    writer.write(indices[0], 3);
+
+    for (int i = 1; i < 16; ++i) {
+        writer.write(indices[i], 4);
+    }
+}
+
+// ---- ETC2 RGB, individual and differential modes shared with ETC1 ----
+
+constexpr int etc_modifiers[8][2] = {
+    {2, 8}, {5, 17}, {9, 29}, {13, 42}, {18, 60}, {24, 80}, {33, 106}, {47, 183},
+};
+
+// best modifier table and per-pixel selectors for one half of a block
+struct etc_subblock {
+    int table = 0;
+    float error = std::numeric_limits<float>::max();
+    unsigned char selectors[8] = {};
+};
+
+// pixel numbers of the two halves, side by side or (flipped) stacked
+void etc_subblock_pixels(int flip, int half, int *pixel) {
+    for (int i = 0; i < 8; ++i) {
+        auto const x = flip ? i % 4 : half * 2 + i / 4;
+        auto const y = flip ? half * 2 + i / 4 : i % 4;
+        pixel[i] = y * 4 + x;
+    }
+}
+
+etc_subblock fit_etc_subblock(
+    block_pixels const& pixels,
+    int const *pixel,
+    int const *base
+) {
+    auto best = etc_subblock{};
+
+    for (int table = 0; table < 8; ++table) {
+        auto candidate = etc_subblock{table, 0.0f, {}};
+
+        for (int i = 0; i < 8; ++i) {
+            auto best_error = std::numeric_limits<float>::max();
+
+            // selector 0: +small, 1: +large, 2: -small, 3: -large
+            for (int selector = 0; selector < 4; ++selector) {
+                auto const modifier = etc_modifiers[table][selector & 1]
+                                    * (selector >= 2 ? -1 : 1);
+                float colour[3];
+
+                for (int c = 0; c < 3; ++c) {
+                    auto const value = std::clamp(base[c] + modifier, 0, 255);
+                    colour[c] = static_cast<float>(value);
+                }
+
+                auto const error = squared_error(pixels[pixel[i]].data(), colour, 3);
+
+                if (error < best_error) {
+                    best_error = error;
+                    candidate.selectors[i] = static_cast<unsigned char>(selector);
+                }
+            }
+
+            candidate.error += best_error;
+        }
+
+        if (candidate.error < best.error) {
+            best = candidate;
+        }
+    }
+
+    return best;
+}
+
+int expand_4(int value) {
+    return value << 4 | value;
+}
+
+int expand_5(int value) {
+    return value << 3 | value >> 2;
+}
+
+// fit a half block to the base colour `quantized` in `bits` bits per channel
+etc_subblock fit_etc_quantized(
+    block_pixels const& pixels,
+    int const *pixel,
+    int const *quantized,
+    int bits
+) {
+    int base[3];
+
+    for (int c = 0; c < 3; ++c) {
+        base[c] = bits == 4 ? expand_4(quantized[c]) : expand_5(quantized[c]);
+    }
+
+    return fit_etc_subblock(pixels, pixel, base);
+}
+
+// search the quantized colours within `radius` of `quantized` for the best
+// fit, `allowed` rejects colours that can't be encoded
+template <typename Allowed>
+etc_subblock search_etc_base(
+    block_pixels const& pixels,
+    int const *pixel,
+    int *quantized,
+    int bits,
+    int radius,
+    Allowed allowed
+) {
+    auto const max = (1 << bits) - 1;
+    auto best = etc_subblock{};
+    int centre[3] = {quantized[0], quantized[1], quantized[2]};
+
+    for (int dr = -radius; dr <= radius; ++dr) {
+        for (int dg = -radius; dg <= radius; ++dg) {
+            for (int db = -radius; db <= radius; ++db) {
+                int const candidate[3] = {
+                    std::clamp(centre[0] + dr, 0, max),
+                    std::clamp(centre[1] + dg, 0, max),
+                    std::clamp(centre[2] + db, 0, max),
+                };
+
+                if (!allowed(candidate)) {
+                    continue;
+                }
+
+                auto const fit = fit_etc_quantized(pixels, pixel, candidate, bits);
+
+                if (fit.error < best.error) {
+                    best = fit;
+                    std::copy(candidate, candidate + 3, quantized);
+                }
+            }
+        }
+    }
+
+    return best;
+}
+
+void encode_etc2_rgb(
+    block_pixels const& pixels,
+    compression_quality quality,
+    unsigned char *out
+) {
+    auto const flips = quality == compression_quality::fast ? 1 : 2;
+    auto const radius = quality == compression_quality::high ? 1 : 0;
+    auto best_error = std::numeric_limits<float>::max();
+    std::uint64_t best_bits = 0;
+
+    for (int flip = 0; flip < flips; ++flip) {
+        int pixel[2][8];
+        float average[2][3] = {};
+
+        for (int half = 0; half < 2; ++half) {
+            etc_subblock_pixels(flip, half, pixel[half]);
+
+            for (int i = 0; i < 8; ++i) {
+                for (int c = 0; c < 3; ++c) {
+                    average[half][c] += pixels[pixel[half][i]][c] / 8.0f;
+                }
+            }
+        }
+
+        // individual mode, two independent 4-bit colours
+        int individual[2][3];
+        etc_subblock individual_fit[2];
+
+        for (int half = 0; half < 2; ++half) {
+            for (int c = 0; c < 3; ++c) {
+                individual[half][c] = static_cast<int>(
+                    std::lround(average[half][c] * 15.0f / 255.0f)
+                );
+            }
+
+            individual_fit[half] = search_etc_base(
+                pixels,
+                pixel[half],
+                individual[half],
+                4,
+                radius,
+                [](int const *) { return true; }
+            );
+        }
+
+        // differential mode, a 5-bit colour and a 3-bit signed offset to the
+        // second one; offsets that leave 0..31 would select an ETC2-only mode
+        int differential[2][3];
+        etc_subblock differential_fit[2];
+
+        for (int half = 0; half < 2; ++half) {
+            for (int c = 0; c < 3; ++c) {
+                differential[half][c] = static_cast<int>(
+                    std::lround(average[half][c] * 31.0f / 255.0f)
+                );
+            }
+        }
+
+        differential_fit[0] = search_etc_base(
+            pixels,
+            pixel[0],
+            differential[0],
+            5,
+            radius,
+            [](int const *) { return true; }
+        );
+
+        for (int c = 0; c < 3; ++c) {
+            auto const delta = std::clamp(differential[1][c] - differential[0][c], -4, 3);
+            differential[1][c] = differential[0][c] + delta;
+        }
+
+        differential_fit[1] = search_etc_base(
+            pixels,
+            pixel[1],
+            differential[1],
+            5,
+            radius,
+            [&](int const *candidate) {
+                for (int c = 0; c < 3; ++c) {
+                    auto const delta = candidate[c] - differential[0][c];
+
+                    if (delta < -4 || delta > 3) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+        );
+
+        for (int diff = 0; diff < 2; ++diff) {
+            auto const *fit = diff ? differential_fit : individual_fit;
+            auto const error = fit[0].error + fit[1].error;
+
+            if (error >= best_error) {
+                continue;
+            }
+
+            std::uint64_t bits = 0;
+
+            for (int c = 0; c < 3; ++c) {
+                auto const shift = 56 - 8 * c;
+
+                if (diff) {
+                    auto const delta = differential[1][c] - differential[0][c];
+                    bits |= static_cast<std::uint64_t>(differential[0][c]) << (shift + 3);
+                    bits |= static_cast<std::uint64_t>(delta & 7) << shift;
+                } else {
+                    bits |= static_cast<std::uint64_t>(individual[0][c]) << (shift + 4);
+                    bits |= static_cast<std::uint64_t>(individual[1][c]) << shift;
+                }
+            }
+
+            bits |= static_cast<std::uint64_t>(fit[0].table) << 37;
+            bits |= static_cast<std::uint64_t>(fit[1].table) << 34;
+            bits |= static_cast<std::uint64_t>(diff) << 33;
+            bits |= static_cast<std::uint64_t>(flip) << 32;
+
+            // selector planes are ordered down each column
+            for (int half = 0; half < 2; ++half) {
+                for (int i = 0; i < 8; ++i) {
+                    auto const x = pixel[half][i] % 4;
+                    auto const y = pixel[half][i] / 4;
+                    auto const bit = x * 4 + y;
+                    auto const selector = fit[half].selectors[i];
+
+                    bits |= static_cast<std::uint64_t>(selector >> 1) << (16 + bit);
+                    bits |= static_cast<std::uint64_t>(selector & 1) << bit;
+                }
+            }
+
+            best_error = error;
+            best_bits = bits;
+        }
+    }
+
+    for (int i = 0; i < 8; ++i) {
+        out[i] = static_cast<unsigned char>(best_bits >> (56 - 8 * i));
+    }
+}
+
+} // namespace
+
+unsigned int compressed_internal_format(block_format format, bool srgb) {
+    switch (format) {
+        case block_format::bc1:
+            return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+                        : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+        case block_format::bc3:
+            return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+                        : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        case block_format::bc7:
+            return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+                        : GL_COMPRESSED_RGBA_BPTC_UNORM;
+        default:
+            return srgb ? GL_COMPRESSED_SRGB8_ETC2 : GL_COMPRESSED_RGB8_ETC2;
+    }
+}
+
+std::vector<unsigned char> compress_image(
+    unsigned char const *rgba,
+    int width,
+    int height,
+    block_format format,
+    compression_quality quality,
+    unsigned int threads
+) {
+    auto const block_bytes =
+        format == block_format::bc1 || format == block_format::etc2_rgb ? 8 : 16;
+    auto const blocks_x = (width + 3) / 4;
+    auto const blocks_y = (height + 3) / 4;
+    auto out = std::vector<unsigned char>(
+        static_cast<std::size_t>(blocks_x) * blocks_y * block_bytes
+    );
+
+    auto const encode_rows = [&](int first, int last) {
+        auto pixels = block_pixels{};
+
+        for (int y = first; y < last; ++y) {
+            for (int x = 0; x < blocks_x; ++x) {
+                auto *block = out.data()
+                            + (static_cast<std::size_t>(y) * blocks_x + x) * block_bytes;
+                load_block(rgba, width, height, x, y, pixels);
+
+                switch (format) {
+                    case block_format::bc1:
+                        encode_bc1(pixels, quality, block);
+                        break;
+                    case block_format::bc3:
+                        encode_bc3(pixels, quality, block);
+                        break;
+                    case block_format::bc7:
+                        encode_bc7(pixels, quality, block);
+                        break;
+                    case block_format::etc2_rgb:
+                        encode_etc2_rgb(pixels, quality, block);
+                        break;
+                }
+            }
+        }
+    };
+
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    auto const count = std::min(static_cast<int>(threads), blocks_y);
+
+    if (count <= 1) {
+        encode_rows(0, blocks_y);
+        return out;
+    }
+
+    auto workers = std::vector<std::thread>{};
+    auto const rows_per_thread = (blocks_y + count - 1) / count;
+
+    for (int first = 0; first < blocks_y; first += rows_per_thread) {
+        auto const last = std::min(first + rows_per_thread, blocks_y);
+        workers.emplace_back(encode_rows, first, last);
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    return out;
+}
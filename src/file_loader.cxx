@@ -0,0 +1,59 @@
+#include <file_loader.h>
+
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#else
+#include <random>
+#endif
+
+bool read_file(std::filesystem::path const& path, std::string& out) {
+    std::FILE *file = std::fopen(path.string().c_str(), "rb");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    auto ok = std::fseek(file, 0, SEEK_END) == 0;
+    long const size = ok ? std::ftell(file) : -1L;
+    ok = size >= 0 && std::fseek(file, 0, SEEK_SET) == 0;
+
+    if (ok) {
+        out.resize(static_cast<std::size_t>(size));
+        ok = std::fread(out.data(), 1, out.size(), file) == out.size();
+    }
+
+    std::fclose(file);
+    return ok;
+}
+
+std::vector<loaded_file> read_files(std::vector<std::filesystem::path> const& paths) {
+    auto files = std::vector<loaded_file>{};
+    files.reserve(paths.size());
+
+    for (auto const& path : paths) {
+        auto& file = files.emplace_back(loaded_file{path, {}, false});
+        file.ok = read_file(path, file.contents);
+    }
+
+    return files;
+}
+
+std::filesystem::path temporary_path(std::filesystem::path const& path) {
+    static auto counter = std::atomic<unsigned int>{0};
+
+#if defined(__unix__) || defined(__APPLE__)
+    auto const process = static_cast<unsigned long>(getpid());
+#else
+    static auto const process = static_cast<unsigned long>(std::random_device{}());
+#endif
+
+    auto tmp = path;
+    tmp += "." + std::to_string(process) + "." + std::to_string(counter++) + ".tmp";
+    return tmp;
+}
@@ -0,0 +1,174 @@
+#include <gl_ext.h>
+
+#include <cstring>
+
+int GLEXT_ARB_get_program_binary = 0;
+PFNGLGETPROGRAMBINARYPROC glext_glGetProgramBinary = NULL;
+PFNGLPROGRAMBINARYPROC glext_glProgramBinary = NULL;
+PFNGLPROGRAMPARAMETERIPROC glext_glProgramParameteri = NULL;
+
+int GLEXT_ARB_separate_shader_objects = 0;
+PFNGLUSEPROGRAMSTAGESPROC glext_glUseProgramStages = NULL;
+PFNGLACTIVESHADERPROGRAMPROC glext_glActiveShaderProgram = NULL;
+PFNGLGENPROGRAMPIPELINESPROC glext_glGenProgramPipelines = NULL;
+PFNGLDELETEPROGRAMPIPELINESPROC glext_glDeleteProgramPipelines = NULL;
+PFNGLBINDPROGRAMPIPELINEPROC glext_glBindProgramPipeline = NULL;
+PFNGLVALIDATEPROGRAMPIPELINEPROC glext_glValidateProgramPipeline = NULL;
+PFNGLGETPROGRAMPIPELINEIVPROC glext_glGetProgramPipelineiv = NULL;
+PFNGLGETPROGRAMPIPELINEINFOLOGPROC glext_glGetProgramPipelineInfoLog = NULL;
+
+int GLEXT_ARB_buffer_storage = 0;
+PFNGLBUFFERSTORAGEPROC glext_glBufferStorage = NULL;
+
+int GLEXT_ARB_texture_storage = 0;
+PFNGLTEXSTORAGE2DPROC glext_glTexStorage2D = NULL;
+PFNGLTEXSTORAGE3DPROC glext_glTexStorage3D = NULL;
+
+int GLEXT_ARB_bindless_texture = 0;
+PFNGLGETTEXTUREHANDLEARBPROC glext_glGetTextureHandleARB = NULL;
+PFNGLGETTEXTURESAMPLERHANDLEARBPROC glext_glGetTextureSamplerHandleARB = NULL;
+PFNGLMAKETEXTUREHANDLERESIDENTARBPROC glext_glMakeTextureHandleResidentARB = NULL;
+PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC glext_glMakeTextureHandleNonResidentARB = NULL;
+
+int GLEXT_EXT_texture_compression_s3tc = 0;
+int GLEXT_EXT_texture_sRGB_s3tc = 0;
+int GLEXT_ARB_texture_compression_bptc = 0;
+int GLEXT_ARB_ES3_compatibility = 0;
+
+int GLEXT_KHR_parallel_shader_compile = 0;
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glext_glMaxShaderCompilerThreadsKHR = NULL;
+
+bool has_gl_version(int major, int minor) {
+    return GLVersion.major > major || (GLVersion.major == major && GLVersion.minor >= minor);
+}
+
+bool has_gl_extension(char const *name) {
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+    for (int i = 0; i < count; ++i) {
+        auto const *ext = reinterpret_cast<char const *>(glGetStringi(GL_EXTENSIONS, i));
+
+        if (ext != NULL && std::strcmp(ext, name) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void load_gl_extensions(GLADloadproc load) {
+    if (has_gl_version(4, 1) || has_gl_extension("GL_ARB_get_program_binary")) {
+        glext_glGetProgramBinary =
+            reinterpret_cast<PFNGLGETPROGRAMBINARYPROC>(load("glGetProgramBinary"));
+        glext_glProgramBinary =
+            reinterpret_cast<PFNGLPROGRAMBINARYPROC>(load("glProgramBinary"));
+        glext_glProgramParameteri =
+            reinterpret_cast<PFNGLPROGRAMPARAMETERIPROC>(load("glProgramParameteri"));
+
+        GLEXT_ARB_get_program_binary = glext_glGetProgramBinary != NULL
+                                    && glext_glProgramBinary != NULL
+                                    && glext_glProgramParameteri != NULL;
+    }
+
+    if (has_gl_version(4, 1) || has_gl_extension("GL_ARB_separate_shader_objects")) {
+        glext_glProgramParameteri =
+            reinterpret_cast<PFNGLPROGRAMPARAMETERIPROC>(load("glProgramParameteri"));
+        glext_glUseProgramStages =
+            reinterpret_cast<PFNGLUSEPROGRAMSTAGESPROC>(load("glUseProgramStages"));
+        glext_glActiveShaderProgram =
+            reinterpret_cast<PFNGLACTIVESHADERPROGRAMPROC>(load("glActiveShaderProgram"));
+        glext_glGenProgramPipelines =
+            reinterpret_cast<PFNGLGENPROGRAMPIPELINESPROC>(load("glGenProgramPipelines"));
+        glext_glDeleteProgramPipelines =
+            reinterpret_cast<PFNGLDELETEPROGRAMPIPELINESPROC>(
+                load("glDeleteProgramPipelines")
+            );
+        glext_glBindProgramPipeline =
+            reinterpret_cast<PFNGLBINDPROGRAMPIPELINEPROC>(load("glBindProgramPipeline"));
+        glext_glValidateProgramPipeline =
+            reinterpret_cast<PFNGLVALIDATEPROGRAMPIPELINEPROC>(
+                load("glValidateProgramPipeline")
+            );
+        glext_glGetProgramPipelineiv = reinterpret_cast<PFNGLGETPROGRAMPIPELINEIVPROC>(
+            load("glGetProgramPipelineiv")
+        );
+        glext_glGetProgramPipelineInfoLog =
+            reinterpret_cast<PFNGLGETPROGRAMPIPELINEINFOLOGPROC>(
+                load("glGetProgramPipelineInfoLog")
+            );
+
+        GLEXT_ARB_separate_shader_objects = glext_glProgramParameteri != NULL
+                                         && glext_glUseProgramStages != NULL
+                                         && glext_glActiveShaderProgram != NULL
+                                         && glext_glGenProgramPipelines != NULL
+                                         && glext_glDeleteProgramPipelines != NULL
+                                         && glext_glBindProgramPipeline != NULL
+                                         && glext_glValidateProgramPipeline != NULL
+                                         && glext_glGetProgramPipelineiv != NULL
+                                         && glext_glGetProgramPipelineInfoLog != NULL;
+    }
+
+    if (has_gl_version(4, 4) || has_gl_extension("GL_ARB_buffer_storage")) {
+        glext_glBufferStorage =
+            reinterpret_cast<PFNGLBUFFERSTORAGEPROC>(load("glBufferStorage"));
+        GLEXT_ARB_buffer_storage = glext_glBufferStorage != NULL;
+    }
+
+    if (has_gl_version(4, 2) || has_gl_extension("GL_ARB_texture_storage")) {
+        glext_glTexStorage2D =
+            reinterpret_cast<PFNGLTEXSTORAGE2DPROC>(load("glTexStorage2D"));
+        glext_glTexStorage3D =
+            reinterpret_cast<PFNGLTEXSTORAGE3DPROC>(load("glTexStorage3D"));
+        GLEXT_ARB_texture_storage =
+            glext_glTexStorage2D != NULL && glext_glTexStorage3D != NULL;
+    }
+
+    if (has_gl_extension("GL_ARB_bindless_texture")) {
+        glext_glGetTextureHandleARB =
+            reinterpret_cast<PFNGLGETTEXTUREHANDLEARBPROC>(load("glGetTextureHandleARB"));
+        glext_glGetTextureSamplerHandleARB =
+            reinterpret_cast<PFNGLGETTEXTURESAMPLERHANDLEARBPROC>(
+                load("glGetTextureSamplerHandleARB")
+            );
+        glext_glMakeTextureHandleResidentARB =
+            reinterpret_cast<PFNGLMAKETEXTUREHANDLERESIDENTARBPROC>(
+                load("glMakeTextureHandleResidentARB")
+            );
+        glext_glMakeTextureHandleNonResidentARB =
+            reinterpret_cast<PFNGLMAKETEXTUREHANDLENONRESIDENTARBPROC>(
+                load("glMakeTextureHandleNonResidentARB")
+            );
+
+        GLEXT_ARB_bindless_texture = glext_glGetTextureHandleARB != NULL
+                                  && glext_glGetTextureSamplerHandleARB != NULL
+                                  && glext_glMakeTextureHandleResidentARB != NULL
+                                  && glext_glMakeTextureHandleNonResidentARB != NULL;
+    }
+
+    GLEXT_EXT_texture_compression_s3tc =
+        has_gl_extension("GL_EXT_texture_compression_s3tc");
+    GLEXT_EXT_texture_sRGB_s3tc =
+        GLEXT_EXT_texture_compression_s3tc
+        && (has_gl_extension("GL_EXT_texture_sRGB")
+            || has_gl_extension("GL_EXT_texture_compression_s3tc_srgb"));
+    GLEXT_ARB_texture_compression_bptc =
+        has_gl_version(4, 2) || has_gl_extension("GL_ARB_texture_compression_bptc");
+    GLEXT_ARB_ES3_compatibility =
+        has_gl_version(4, 3) || has_gl_extension("GL_ARB_ES3_compatibility");
+
+    // the ARB variant shares its enums with the KHR one
+    char const *threads_proc = NULL;
+
+    if (has_gl_extension("GL_KHR_parallel_shader_compile")) {
+        threads_proc = "glMaxShaderCompilerThreadsKHR";
+    } else if (has_gl_extension("GL_ARB_parallel_shader_compile")) {
+        threads_proc = "glMaxShaderCompilerThreadsARB";
+    }
+
+    if (threads_proc != NULL) {
+        glext_glMaxShaderCompilerThreadsKHR =
+            reinterpret_cast<PFNGLMAXSHADERCOMPILERTHREADSKHRPROC>(load(threads_proc));
+        GLEXT_KHR_parallel_shader_compile = glext_glMaxShaderCompilerThreadsKHR != NULL;
+    }
+}
@@ -0,0 +1,193 @@
+#include <image_ops.h>
+
+#include <cstddef>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// c * a / 255 rounded to nearest, exact for every 8-bit pair
+unsigned char multiply_alpha(unsigned int c, unsigned int a) {
+    auto const product = c * a + 128;
+    return static_cast<unsigned char>((product + (product >> 8)) >> 8);
+}
+
+} // namespace
+
+void flip_rows(unsigned char *pixels, std::size_t row_bytes, int height) {
+    for (int y = 0; y < height / 2; ++y) {
+        auto *top = pixels + static_cast<std::size_t>(y) * row_bytes;
+        auto *bottom = pixels + static_cast<std::size_t>(height - 1 - y) * row_bytes;
+        std::size_t i = 0;
+
+#if defined(__SSE2__)
+        for (; i + 16 <= row_bytes; i += 16) {
+            auto const a = _mm_loadu_si128(reinterpret_cast<__m128i const *>(top + i));
+            auto const b = _mm_loadu_si128(reinterpret_cast<__m128i const *>(bottom + i));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(top + i), b);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(bottom + i), a);
+        }
+#endif
+
+        for (; i < row_bytes; ++i) {
+            std::swap(top[i], bottom[i]);
+        }
+    }
+}
+
+void expand_rgb_to_rgba(
+    unsigned char const *rgb,
+    unsigned char *rgba,
+    std::size_t count
+) {
+    std::size_t i = 0;
+
+#if defined(__SSE2__)
+    // four texels from twelve bytes: shift texel n up by n bytes into its
+    // own 32-bit lane, the load reads four bytes past them so it stops
+    // while at least six texels are left
+    auto const lane0 = _mm_set_epi32(0, 0, 0, 0x00FFFFFF);
+    auto const lane1 = _mm_set_epi32(0, 0, 0x00FFFFFF, 0);
+    auto const lane2 = _mm_set_epi32(0, 0x00FFFFFF, 0, 0);
+    auto const lane3 = _mm_set_epi32(0x00FFFFFF, 0, 0, 0);
+    auto const alpha = _mm_set1_epi32(static_cast<int>(0xFF000000u));
+
+    for (; i + 6 <= count; i += 4) {
+        auto const texels =
+            _mm_loadu_si128(reinterpret_cast<__m128i const *>(rgb + i * 3));
+
+        auto const low = _mm_or_si128(
+            _mm_and_si128(texels, lane0),
+            _mm_and_si128(_mm_slli_si128(texels, 1), lane1)
+        );
+        auto const high = _mm_or_si128(
+            _mm_and_si128(_mm_slli_si128(texels, 2), lane2),
+            _mm_and_si128(_mm_slli_si128(texels, 3), lane3)
+        );
+
+        _mm_storeu_si128(
+            reinterpret_cast<__m128i *>(rgba + i * 4),
+            _mm_or_si128(_mm_or_si128(low, high), alpha)
+        );
+    }
+#endif
+
+    for (; i < count; ++i) {
+        rgba[i * 4 + 0] = rgb[i * 3 + 0];
+        rgba[i * 4 + 1] = rgb[i * 3 + 1];
+        rgba[i * 4 + 2] = rgb[i * 3 + 2];
+        rgba[i * 4 + 3] = 255;
+    }
+}
+
+void swizzle_bgra(unsigned char *pixels, std::size_t count, int channels) {
+    if (channels != 3 && channels != 4) {
+        return;
+    }
+
+    std::size_t i = 0;
+
+#if defined(__SSE2__)
+    // bytes 0 and 2 of each 32-bit texel trade places with two shifts,
+    // green and alpha stay where they are
+    if (channels == 4) {
+        auto const red_blue = _mm_set1_epi32(0x00FF00FF);
+
+        for (; i + 4 <= count; i += 4) {
+            auto *at = reinterpret_cast<__m128i *>(pixels + i * 4);
+            auto const texels = _mm_loadu_si128(at);
+            auto const swapped = _mm_and_si128(texels, red_blue);
+
+            _mm_storeu_si128(
+                at,
+                _mm_or_si128(
+                    _mm_andnot_si128(red_blue, texels),
+                    _mm_or_si128(_mm_slli_epi32(swapped, 16), _mm_srli_epi32(swapped, 16))
+                )
+            );
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        std::swap(pixels[i * channels], pixels[i * channels + 2]);
+    }
+}
+
+void premultiply_alpha(unsigned char *pixels, std::size_t count, int channels) {
+    if (channels != 2 && channels != 4) {
+        return;
+    }
+
+    std::size_t i = 0;
+
+#if defined(__SSE2__)
+    // two texels per register widened to 16 bits, alpha is broadcast over
+    // its texel and multiplied by 255 in its own lane so it comes out as is
+    if (channels == 4) {
+        auto const zero = _mm_setzero_si128();
+        auto const colour = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+        auto const opaque = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+        auto const bias = _mm_set1_epi16(128);
+
+        auto const multiply = [&](__m128i texels) {
+            auto const alpha = _mm_shufflehi_epi16(
+                _mm_shufflelo_epi16(texels, _MM_SHUFFLE(3, 3, 3, 3)),
+                _MM_SHUFFLE(3, 3, 3, 3)
+            );
+            auto const factor = _mm_or_si128(_mm_and_si128(alpha, colour), opaque);
+            auto const product = _mm_add_epi16(_mm_mullo_epi16(texels, factor), bias);
+
+            return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+        };
+
+        for (; i + 4 <= count; i += 4) {
+            auto *at = reinterpret_cast<__m128i *>(pixels + i * 4);
+            auto const texels = _mm_loadu_si128(at);
+
+            _mm_storeu_si128(
+                at,
+                _mm_packus_epi16(
+                    multiply(_mm_unpacklo_epi8(texels, zero)),
+                    multiply(_mm_unpackhi_epi8(texels, zero))
+                )
+            );
+        }
+    }
+#endif
+
+    for (; i < count; ++i) {
+        auto *texel = pixels + i * channels;
+        auto const alpha = texel[channels - 1];
+
+        for (int c = 0; c < channels - 1; ++c) {
+            texel[c] = multiply_alpha(texel[c], alpha);
+        }
+    }
+}
+
+void transform_image(
+    unsigned char *pixels,
+    int width,
+    int height,
+    int channels,
+    image_options const& options
+) {
+    auto const count = static_cast<std::size_t>(width) * height;
+
+    if (options.flip) {
+        flip_rows(pixels, static_cast<std::size_t>(width) * channels, height);
+    }
+
+    if (options.swizzle_bgra) {
+        swizzle_bgra(pixels, count, channels);
+    }
+
+    if (options.premultiply) {
+        premultiply_alpha(pixels, count, channels);
+    }
+}
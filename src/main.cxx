@@ -1,6 +1,12 @@
+#include <array>
+#include <cstddef>
 #include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
 
 // clang-format off
 #include <glad/glad.h>
@@ -9,12 +15,53 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
-
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
 // clang-format on
 
+#include <bindless_textures.h>
+#include <gl_ext.h>
 #include <shader.h>
+#include <shader_library.h>
+#include <shader_watcher.h>
+#include <startup_trace.h>
+#include <texture_array.h>
+#include <texture_cache.h>
+#include <uniform_buffer.h>
+#include <virtual_texture.h>
+
+// per-frame data shared by every program through the `frame` uniform block
+struct frame_data {
+    glm::mat4 view;
+    glm::mat4 projection;
+};
+
+using frame_layout = std140::layout<glm::mat4, glm::mat4>;
+static_assert(offsetof(frame_data, view) == frame_layout::offset(0));
+static_assert(offsetof(frame_data, projection) == frame_layout::offset(1));
+static_assert(sizeof(frame_data) == frame_layout::size);
+
+// per-instance attributes of the TEXTURE_ARRAY variant, the layers index
+// the array both textures were packed into
+struct instance_data {
+    glm::mat4 transform;
+    glm::vec2 layers;
+};
+
+// texel bytes uploaded per frame, keeps texture streaming from causing hitches
+constexpr std::size_t texture_upload_budget = 4 * 1024 * 1024;
+
+// video memory unreferenced textures may keep resident before being evicted
+constexpr std::size_t texture_vram_budget = 256 * 1024 * 1024;
+
+// handles in the BINDLESS variant's table, must be even
+constexpr int bindless_capacity = 256;
+
+// the virtual texture feedback pass renders at 1/8 of the window size, so
+// its level is biased by log2(8) to match the full resolution pass
+constexpr int feedback_scale = 8;
+constexpr float feedback_lod_bias = -3.0f;
+
+// tiles uploaded into the virtual texture atlas per frame
+constexpr int virtual_tiles_per_frame = 8;
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 
@@ -24,11 +71,41 @@ void process_input(GLFWwindow *window) {
     }
 }
 
-int main() {
+int main(int argc, char **argv) {
     std::atexit(glfwTerminate);
     std::at_quick_exit(glfwTerminate);
     std::set_terminate(glfwTerminate);
 
+    // `--wireframe` draws polygon outlines using the WIREFRAME shader variant,
+    // `--trace` prints how long each startup step took, `--cpu-mips` filters
+    // texture mip levels on the decode threads instead of glGenerateMipmap,
+    // `--texture-array` packs both textures into one array and draws every
+    // quad with a single instanced call, `--bindless` draws the same way but
+    // samples resident texture handles, falling back to `--texture-array`
+    // without ARB_bindless_texture. `--virtual-texture file.tex` streams a
+    // baked container in place of the first texture
+    auto wireframe = false;
+    auto trace = false;
+    auto cpu_mips = false;
+    auto texture_array = false;
+    auto bindless = false;
+    auto virtual_texture_path = std::string{};
+
+    for (int i = 1; i < argc; ++i) {
+        wireframe = wireframe || std::string_view{argv[i]} == "--wireframe";
+        trace = trace || std::string_view{argv[i]} == "--trace";
+        cpu_mips = cpu_mips || std::string_view{argv[i]} == "--cpu-mips";
+        texture_array = texture_array || std::string_view{argv[i]} == "--texture-array";
+        bindless = bindless || std::string_view{argv[i]} == "--bindless";
+
+        if (std::string_view{argv[i]} == "--virtual-texture" && i + 1 < argc) {
+            virtual_texture_path = argv[++i];
+        }
+    }
+
+    startup_trace::set_enabled(trace);
+    auto startup = std::optional<startup_trace::scope>{std::in_place, "startup"};
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -51,9 +128,74 @@ int main() {
         return -1;
     }
 
+    load_gl_extensions((GLADloadproc)glfwGetProcAddress);
+
     glViewport(0, 0, 800, 600);
 
-    auto shader_program = Shader("shaders/basic.vert", "shaders/basic.frag");
+    if (bindless && !BindlessTextureTable::supported()) {
+        std::cout << "ARB_bindless_texture is unavailable, using texture arrays.\n";
+        bindless = false;
+        texture_array = true;
+    }
+
+    if (!virtual_texture_path.empty() && (texture_array || bindless)) {
+        std::cout << "--virtual-texture only replaces the first of the bound textures.\n";
+        texture_array = false;
+        bindless = false;
+    }
+
+    // only the coarsest level is read here, the rest streams in as the
+    // feedback pass asks for it. Opened before the shader variant is picked
+    // so a bad container falls back to the plain textures
+    auto virtual_texture = std::optional<VirtualTexture>{};
+    auto feedback = std::optional<VirtualTextureFeedback>{};
+
+    if (!virtual_texture_path.empty()) {
+        virtual_texture.emplace(virtual_texture_path);
+
+        if (virtual_texture->ok()) {
+            feedback.emplace(800 / feedback_scale, 600 / feedback_scale);
+        } else {
+            std::cerr << "ERROR::VIRTUAL_TEXTURE::NOT_LOADED\n"
+                      << virtual_texture_path << ", using the plain textures\n";
+            virtual_texture.reset();
+            virtual_texture_path.clear();
+        }
+    }
+
+    auto const instanced = texture_array || bindless;
+
+    auto defines = shader_defines{};
+
+    if (wireframe) {
+        defines.push_back({"WIREFRAME", ""});
+    }
+
+    if (texture_array) {
+        defines.push_back({"TEXTURE_ARRAY", ""});
+    }
+
+    if (bindless) {
+        defines.push_back({"BINDLESS", ""});
+        defines.push_back({"BINDLESS_CAPACITY", std::to_string(bindless_capacity)});
+    }
+
+    if (!virtual_texture_path.empty()) {
+        defines.push_back({"VIRTUAL_TEXTURE", ""});
+    }
+
+    auto const feedback_defines = shader_defines{
+        {"VIRTUAL_TEXTURE", ""},
+        {"VIRTUAL_TEXTURE_FEEDBACK", ""},
+    };
+
+    // submitted up front so the driver compiles while textures are decoded
+    auto shaders = ShaderLibrary();
+    shaders.add("basic", "shaders/basic.vert", "shaders/basic.frag", defines);
+
+    if (!virtual_texture_path.empty()) {
+        shaders.request("basic", feedback_defines);
+    }
 
     // ---- Triangle ----
     // clang-format off
@@ -93,82 +235,210 @@ int main() {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
 
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // colour attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    // colour attribute
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-
-    unsigned int texture0 = 0;
-    glGenTextures(1, &texture0);
-    glBindTexture(GL_TEXTURE_2D, texture0);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    int width0 = 0;
-    int height0 = 0;
-    int nr_channels0 = 0;
-    unsigned char *tex_data0 = stbi_load("assets/container.jpg", &width0, &height0, &nr_channels0, 0);
-
-    if (tex_data0 != NULL) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width0, height0, 0, GL_RGB, GL_UNSIGNED_BYTE, tex_data0);
-        glGenerateMipmap(GL_TEXTURE_2D);
+    // position, colour and texel attributes, checked against the program
+    // once it has linked
+    auto vertex_layout = std::vector<vertex_attribute>{{0, 3}, {1, 3}, {2, 2}};
+    int vertex_offset = 0;
+
+    for (auto const& attribute : vertex_layout) {
+        glVertexAttribPointer(
+            attribute.location,
+            attribute.components,
+            GL_FLOAT,
+            GL_FALSE,
+            8 * sizeof(float),
+            (void*)(vertex_offset * sizeof(float))
+        );
+        glEnableVertexAttribArray(attribute.location);
+        vertex_offset += attribute.components;
+    }
+
+    // transform and layers advance once per instance, a mat4 input takes
+    // one location per column
+    unsigned int instance_VBO = 0;
+
+    if (instanced) {
+        glGenBuffers(1, &instance_VBO);
+        glBindBuffer(GL_ARRAY_BUFFER, instance_VBO);
+        glBufferData(GL_ARRAY_BUFFER, 2 * sizeof(instance_data), NULL, GL_STREAM_DRAW);
+
+        glVertexAttribPointer(
+            3,
+            2,
+            GL_FLOAT,
+            GL_FALSE,
+            sizeof(instance_data),
+            (void*)offsetof(instance_data, layers)
+        );
+        glEnableVertexAttribArray(3);
+        glVertexAttribDivisor(3, 1);
+
+        for (int column = 0; column < 4; ++column) {
+            glVertexAttribPointer(
+                4 + column,
+                4,
+                GL_FLOAT,
+                GL_FALSE,
+                sizeof(instance_data),
+                (void*)(offsetof(instance_data, transform) + column * sizeof(glm::vec4))
+            );
+            glEnableVertexAttribArray(4 + column);
+            glVertexAttribDivisor(4 + column, 1);
+        }
+
+        vertex_layout.push_back({3, 2});
+        vertex_layout.push_back({4, 16});
+    }
+
+    // decoded in the background and uploaded a slice per frame, the
+    // placeholder is bound until then
+    auto textures = TextureCache(
+        texture_vram_budget,
+        0,
+        cpu_mips ? mip_generation::cpu : mip_generation::gpu
+    );
+    auto texture0 = cached_texture{};
+    auto texture1 = cached_texture{};
+
+    // the array variant decodes up front and samples one array for both
+    auto arrays = std::vector<Texture2DArray>{};
+    auto layer0 = texture_layer{};
+    auto layer1 = texture_layer{};
+
+    if (texture_array) {
+        auto builder = TextureArrayBuilder();
+        layer0 = builder.add("assets/container.jpg");
+        layer1 = builder.add("assets/awesomeface.png", image_options{.flip = true});
+        arrays = builder.build();
+
+        if (layer0.array != layer1.array) {
+            std::cerr << "ERROR::TEXTURE_ARRAY::SIZE_MISMATCH\n"
+                      << "container.jpg and awesomeface.png landed in different arrays\n";
+        }
     } else {
-        std::cerr << "Failed to load texture0.\n";
+        // bindless handles are taken from the cache's textures once loaded
+        if (virtual_texture_path.empty()) {
+            texture0 = textures.acquire(
+                "assets/container.jpg",
+                {},
+                image_options{.expand_rgba = true}
+            );
+        }
+
+        texture1 = textures.acquire(
+            "assets/awesomeface.png",
+            {},
+            image_options{.flip = true}
+        );
     }
 
-    stbi_image_free(tex_data0);
+    if (wireframe) {
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+    }
 
-    unsigned int texture1 = 0;
-    glGenTextures(1, &texture1);
-    glBindTexture(GL_TEXTURE_2D, texture1);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    auto shaders_trace = std::optional<startup_trace::scope>{std::in_place, "wait for shaders"};
+    auto& shader_program = shaders.get("basic", defines);
+    shaders_trace.reset();
 
-    int width1 = 0;
-    int height1 = 0;
-    int nr_channels1 = 0;
-    stbi_set_flip_vertically_on_load(true);
-    unsigned char *tex_data1 = stbi_load("assets/awesomeface.png", &width1, &height1, &nr_channels1, 0);
+    shader_program.validate_vertex_layout(vertex_layout);
 
-    if (tex_data1 != NULL) {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width1, height1, 0, GL_RGBA, GL_UNSIGNED_BYTE, tex_data1);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    } else {
-        std::cerr << "Failed to load texture1.\n";
+    Shader *feedback_program = nullptr;
+
+    if (virtual_texture) {
+        feedback_program = &shaders.get("basic", feedback_defines);
+    }
+
+    // sampler units are assigned by the shader at link time, -1 if the
+    // variant doesn't sample the texture
+    int tex0_unit = shader_program.sampler_unit("tex0");
+    int tex1_unit = shader_program.sampler_unit("tex1");
+    int array_unit = shader_program.sampler_unit("textures");
+
+    auto const transform_uniform = shader_program.uniform("transform"_uniform);
+
+    auto frame_buffer = UniformBuffer(sizeof(frame_data), FRAME_BINDING);
+    shader_program.bind_uniform_block("frame", FRAME_BINDING);
+
+    if (feedback_program != nullptr) {
+        feedback_program->bind_uniform_block("frame", FRAME_BINDING);
+    }
+
+    // slot and texture object of texture0 and texture1 in the handle table,
+    // the loader's placeholder is resident until the texture is ready
+    auto handle_table = std::optional<BindlessTextureTable>{};
+    auto const bindless_sources = std::array<cached_texture, 2>{texture0, texture1};
+    auto bindless_slots = std::array<int, 2>{-1, -1};
+    auto bindless_ids = std::array<unsigned int, 2>{0, 0};
+
+    if (bindless) {
+        handle_table.emplace(bindless_capacity, TEXTURE_HANDLES_BINDING);
+        shader_program.bind_uniform_block("texture_handles", TEXTURE_HANDLES_BINDING);
     }
 
-    stbi_image_free(tex_data1);
+    auto const frame = frame_data{glm::mat4(1.0f), glm::mat4(1.0f)};
+    frame_buffer.update(frame);
+
+    auto watcher = ShaderWatcher();
+    watcher.watch(shader_program);
+
+    if (feedback_program != nullptr) {
+        watcher.watch(*feedback_program);
+    }
 
-    // Compile with -DPOLYGON_MODE to draw in wireframe polygons.
-#ifdef WIREFRAME_MODE
-    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-#endif // WIREFRAME_MODE
+    startup.reset();
 
-    shader_program.use();
-    shader_program.set_uniform("tex0", 0);
-    shader_program.set_uniform("tex1", 1);
+    if (trace) {
+        startup_trace::report(std::cout);
+        startup_trace::set_enabled(false);
+    }
 
     while (!glfwWindowShouldClose(window)) {
         process_input(window);
 
+        // a reloaded program may have started sampling a texture it didn't before
+        if (watcher.apply() > 0) {
+            shader_program.validate_vertex_layout(vertex_layout);
+            tex0_unit = shader_program.sampler_unit("tex0");
+            tex1_unit = shader_program.sampler_unit("tex1");
+            array_unit = shader_program.sampler_unit("textures");
+        }
+
+        textures.update(texture_upload_budget);
+
+        if (virtual_texture) {
+            feedback->resolve(*virtual_texture);
+            virtual_texture->update(virtual_tiles_per_frame);
+        }
+
         glClearColor(0.2f, 0.3f, 0.3f, 1.f);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, texture0);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, texture1);
+        if (tex0_unit >= 0) {
+            textures.bind(texture0, tex0_unit);
+        }
+
+        if (tex1_unit >= 0) {
+            textures.bind(texture1, tex1_unit);
+        }
+
+        if (array_unit >= 0 && layer0.array >= 0) {
+            arrays[layer0.array].bind(array_unit);
+        }
+
+        if (handle_table) {
+            for (std::size_t i = 0; i < bindless_sources.size(); ++i) {
+                auto const id = textures.texture(bindless_sources[i]);
+
+                if (id != bindless_ids[i]) {
+                    handle_table->remove(bindless_slots[i]);
+                    bindless_slots[i] =
+                        handle_table->add(id, textures.sampler(bindless_sources[i]));
+                    bindless_ids[i] = id;
+                }
+            }
+
+            handle_table->update();
+        }
 
         float time = (float)glfwGetTime();
         float scale = abs(sin(time)) + 0.1f;
@@ -181,24 +451,72 @@ int main() {
         transform2 = glm::translate(transform2, glm::vec3(-0.5f, 0.5f, 0.0f));
         transform2 = glm::scale(transform2, glm::vec3(scale, scale, 1.0f));
 
+        // the feedback pass writes the virtual texture page every pixel of
+        // the quads needs
+        if (virtual_texture) {
+            feedback->begin();
+            feedback_program->use();
+            virtual_texture->bind(*feedback_program, feedback_lod_bias);
+
+            for (auto const& quad : {transform, transform2}) {
+                feedback_program->set_uniform("transform"_uniform, quad);
+
+                glBindVertexArray(VAO);
+                glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+            }
+
+            feedback->end();
+        }
+
         shader_program.use();
-        shader_program.set_uniform("transform", transform);
 
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        if (virtual_texture) {
+            virtual_texture->bind(shader_program);
+        }
+
+        if (instanced) {
+            auto const layers = bindless ? glm::vec2(bindless_slots[0], bindless_slots[1])
+                                         : glm::vec2(layer0.layer, layer1.layer);
+            instance_data const instances[] = {{transform, layers}, {transform2, layers}};
+
+            glBindBuffer(GL_ARRAY_BUFFER, instance_VBO);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(instances), instances);
+
+            glBindVertexArray(VAO);
+            glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, 2);
+        } else {
+            shader_program.set_uniform(transform_uniform, transform);
 
-        shader_program.set_uniform("transform", transform2);
+            glBindVertexArray(VAO);
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+            shader_program.set_uniform(transform_uniform, transform2);
+
+            glBindVertexArray(VAO);
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+        }
 
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
+    if (trace) {
+        auto const stats = shader_program.uniform_upload_stats();
+        std::cout << "uniform uploads: " << stats.issued << " issued, " << stats.skipped
+                  << " skipped\n";
+
+        if (virtual_texture) {
+            auto const paging = virtual_texture->stats();
+            std::cout << "virtual texture: " << paging.requests << " requests, "
+                      << paging.uploads << " uploads, " << paging.evictions
+                      << " evictions\n";
+        }
+    }
+
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
+    glDeleteBuffers(1, &instance_VBO);
 
     return 0;
 }
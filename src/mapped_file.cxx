@@ -0,0 +1,184 @@
+#include <mapped_file.h>
+
+#include <file_loader.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(std::filesystem::path const& path, file_access access) {
+#if defined(__unix__) || defined(__APPLE__)
+    int const fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat info = {};
+
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void *view = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (view != MAP_FAILED) {
+            bytes = static_cast<unsigned char const *>(view);
+            length = static_cast<std::size_t>(info.st_size);
+            mapped = true;
+            advise(access);
+        }
+    }
+
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+#else
+    (void)access;
+
+    if (read_file(path, contents) && !contents.empty()) {
+        bytes = reinterpret_cast<unsigned char const *>(contents.data());
+        length = contents.size();
+    }
+#endif
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : bytes(std::exchange(other.bytes, nullptr)), length(std::exchange(other.length, 0)),
+      mapped(std::exchange(other.mapped, false)), contents(std::move(other.contents)) {
+    // a moved std::string may use its small buffer, point at the new copy
+    if (bytes != nullptr && !mapped) {
+        bytes = reinterpret_cast<unsigned char const *>(contents.data());
+    }
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+
+        bytes = std::exchange(other.bytes, nullptr);
+        length = std::exchange(other.length, 0);
+        mapped = std::exchange(other.mapped, false);
+        contents = std::move(other.contents);
+
+        if (bytes != nullptr && !mapped) {
+            bytes = reinterpret_cast<unsigned char const *>(contents.data());
+        }
+    }
+
+    return *this;
+}
+
+void MappedFile::advise(file_access access) const {
+#if defined(__unix__) || defined(__APPLE__)
+    if (!mapped) {
+        return;
+    }
+
+    int advice = MADV_NORMAL;
+
+    if (access == file_access::sequential) {
+        advice = MADV_SEQUENTIAL;
+    } else if (access == file_access::random) {
+        advice = MADV_RANDOM;
+    }
+
+    // only a hint, failure changes nothing
+    madvise(const_cast<unsigned char *>(bytes), length, advice);
+#else
+    (void)access;
+#endif
+}
+
+void MappedFile::close() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (mapped) {
+        munmap(const_cast<unsigned char *>(bytes), length);
+    }
+#endif
+
+    bytes = nullptr;
+    length = 0;
+    mapped = false;
+    contents.clear();
+}
+
+namespace mapping_cache {
+
+namespace {
+
+std::mutex cache_mutex;
+std::unordered_map<std::string, std::weak_ptr<MappedFile const>> cache_files;
+
+// live mapping of `path`, dropping its entry if the last holder let go,
+// `cache_mutex` must be held
+std::shared_ptr<MappedFile const> find(std::string const& path) {
+    auto const entry = cache_files.find(path);
+
+    if (entry == cache_files.end()) {
+        return nullptr;
+    }
+
+    auto file = entry->second.lock();
+
+    if (file == nullptr) {
+        cache_files.erase(entry);
+    }
+
+    return file;
+}
+
+} // namespace
+
+std::shared_ptr<MappedFile const> open(
+    std::filesystem::path const& path,
+    file_access access
+) {
+    auto const key = path.string();
+
+    {
+        auto const lock = std::lock_guard{cache_mutex};
+
+        if (auto file = find(key)) {
+            return file;
+        }
+    }
+
+    // map outside the lock, another thread may map the same file meanwhile
+    auto file = std::make_shared<MappedFile const>(path, access);
+    auto const lock = std::lock_guard{cache_mutex};
+
+    if (auto existing = find(key)) {
+        return existing;
+    }
+
+    if (file->ok()) {
+        cache_files[key] = file;
+    }
+
+    return file;
+}
+
+std::size_t size() {
+    auto const lock = std::lock_guard{cache_mutex};
+    std::size_t live = 0;
+
+    for (auto const& [path, file] : cache_files) {
+        live += file.expired() ? 0 : 1;
+    }
+
+    return live;
+}
+
+} // namespace mapping_cache
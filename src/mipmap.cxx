@@ -0,0 +1,445 @@
+#include <mipmap.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// rows of a level handed to each thread at least, smaller levels are
+// filtered on the calling thread
+constexpr int rows_per_band = 64;
+
+// run `filter(first, last)` over `rows` rows, split into bands across up to
+// `threads` threads; the calling thread takes the last band
+template <typename Filter>
+void parallel_rows(int rows, unsigned int threads, Filter const& filter) {
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    auto const bands = std::clamp(rows / rows_per_band, 1, static_cast<int>(threads));
+
+    if (bands == 1) {
+        filter(0, rows);
+        return;
+    }
+
+    auto workers = std::vector<std::thread>{};
+    auto const band_rows = (rows + bands - 1) / bands;
+
+    for (int first = 0; first + band_rows < rows; first += band_rows) {
+        workers.emplace_back(filter, first, first + band_rows);
+    }
+
+    filter(static_cast<int>(workers.size()) * band_rows, rows);
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// ---- 8-bit box filter ----
+
+void box_rows(
+    unsigned char const *pixels,
+    int width,
+    int height,
+    int channels,
+    mip_level& level,
+    int first,
+    int last
+) {
+    auto const stride = static_cast<std::size_t>(width) * channels;
+
+    for (int y = first; y < last; ++y) {
+        auto const *row0 = pixels + std::min(2 * y, height - 1) * stride;
+        auto const *row1 = pixels + std::min(2 * y + 1, height - 1) * stride;
+        auto *out =
+            level.pixels.data() + static_cast<std::size_t>(y) * level.width * channels;
+        int x = 0;
+
+#if defined(__SSE2__)
+        // two RGBA texels out of four in: widen to 16 bits, add the rows,
+        // then add each texel to its neighbour 8 bytes along
+        if (channels == 4) {
+            auto const zero = _mm_setzero_si128();
+            auto const bias = _mm_set1_epi16(2);
+
+            for (; 2 * x + 3 < width; x += 2) {
+                auto const a = _mm_loadu_si128(
+                    reinterpret_cast<__m128i const *>(row0 + x * 8)
+                );
+                auto const b = _mm_loadu_si128(
+                    reinterpret_cast<__m128i const *>(row1 + x * 8)
+                );
+                auto const lo = _mm_add_epi16(
+                    _mm_unpacklo_epi8(a, zero),
+                    _mm_unpacklo_epi8(b, zero)
+                );
+                auto const hi = _mm_add_epi16(
+                    _mm_unpackhi_epi8(a, zero),
+                    _mm_unpackhi_epi8(b, zero)
+                );
+                auto const sum = _mm_unpacklo_epi64(
+                    _mm_add_epi16(lo, _mm_srli_si128(lo, 8)),
+                    _mm_add_epi16(hi, _mm_srli_si128(hi, 8))
+                );
+                auto const average = _mm_srli_epi16(_mm_add_epi16(sum, bias), 2);
+
+                _mm_storel_epi64(
+                    reinterpret_cast<__m128i *>(out + x * 4),
+                    _mm_packus_epi16(average, average)
+                );
+            }
+        }
+#endif
+
+        for (; x < level.width; ++x) {
+            auto const x0 = std::min(2 * x, width - 1) * channels;
+            auto const x1 = std::min(2 * x + 1, width - 1) * channels;
+
+            for (int c = 0; c < channels; ++c) {
+                auto const sum =
+                    row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                out[x * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+mip_level box_downsample(
+    unsigned char const *pixels,
+    int width,
+    int height,
+    int channels,
+    unsigned int threads
+) {
+    auto level = mip_level{std::max(width / 2, 1), std::max(height / 2, 1), {}};
+    level.pixels.resize(static_cast<std::size_t>(level.width) * level.height * channels);
+
+    parallel_rows(level.height, threads, [&](int first, int last) {
+        box_rows(pixels, width, height, channels, level, first, last);
+    });
+
+    return level;
+}
+
+// ---- float filters ----
+
+// image with channels normalised to 0..1, sRGB channels decoded to linear
+struct float_image {
+    int width;
+    int height;
+    std::vector<float> texels;
+};
+
+// separable 2:1 kernel, output texel `x` reads input `2 * x + offset + i`
+// with `weights[i]`
+struct filter_kernel {
+    int offset;
+    std::vector<float> weights;
+};
+
+// zeroth order modified Bessel function of the first kind
+double bessel_i0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+
+    for (int k = 1; k < 32; ++k) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+
+    return sum;
+}
+
+filter_kernel make_kernel(mip_filter filter) {
+    if (filter == mip_filter::box) {
+        return filter_kernel{0, {0.5f, 0.5f}};
+    }
+
+    // taps 2.5 input texels either side of the output centre, sinc scaled to
+    // the output rate and windowed out to 3 input texels
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double alpha = 4.0;
+    constexpr double radius = 3.0;
+
+    auto kernel = filter_kernel{-2, {}};
+    auto total = 0.0;
+    auto weights = std::array<double, 6>{};
+
+    for (int i = 0; i < 6; ++i) {
+        auto const distance = i - 2.5;
+        auto const t = distance / 2.0;
+        auto const sinc = std::sin(pi * t) / (pi * t);
+        auto const r = distance / radius;
+        auto const window = bessel_i0(alpha * std::sqrt(1.0 - r * r)) / bessel_i0(alpha);
+
+        weights[i] = sinc * window;
+        total += weights[i];
+    }
+
+    for (auto const weight : weights) {
+        kernel.weights.push_back(static_cast<float>(weight / total));
+    }
+
+    return kernel;
+}
+
+std::array<float, 256> const& srgb_to_linear_table() {
+    static auto const table = [] {
+        auto values = std::array<float, 256>{};
+
+        for (int i = 0; i < 256; ++i) {
+            auto const c = i / 255.0;
+            auto const linear =
+                c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+            values[i] = static_cast<float>(linear);
+        }
+
+        return values;
+    }();
+
+    return table;
+}
+
+constexpr int linear_table_size = 4096;
+
+std::array<unsigned char, linear_table_size> const& linear_to_srgb_table() {
+    static auto const table = [] {
+        auto values = std::array<unsigned char, linear_table_size>{};
+
+        for (int i = 0; i < linear_table_size; ++i) {
+            auto const l = static_cast<double>(i) / (linear_table_size - 1);
+            auto const c =
+                l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+            values[i] = static_cast<unsigned char>(std::lround(c * 255.0));
+        }
+
+        return values;
+    }();
+
+    return table;
+}
+
+// number of leading channels stored as sRGB, alpha never is
+int srgb_channels(int channels, bool srgb) {
+    return srgb && channels >= 3 ? 3 : 0;
+}
+
+float_image to_float(
+    unsigned char const *pixels,
+    int width,
+    int height,
+    int channels,
+    bool srgb
+) {
+    auto const& decode = srgb_to_linear_table();
+    auto const encoded = srgb_channels(channels, srgb);
+    auto image = float_image{width, height, {}};
+    image.texels.resize(static_cast<std::size_t>(width) * height * channels);
+
+    for (std::size_t i = 0; i < image.texels.size(); i += channels) {
+        for (int c = 0; c < channels; ++c) {
+            image.texels[i + c] =
+                c < encoded ? decode[pixels[i + c]] : pixels[i + c] / 255.0f;
+        }
+    }
+
+    return image;
+}
+
+mip_level to_level(float_image const& image, int channels, bool srgb) {
+    auto const& encode = linear_to_srgb_table();
+    auto const encoded = srgb_channels(channels, srgb);
+    auto level = mip_level{image.width, image.height, {}};
+    level.pixels.resize(image.texels.size());
+
+    for (std::size_t i = 0; i < image.texels.size(); i += channels) {
+        for (int c = 0; c < channels; ++c) {
+            auto const value = std::clamp(image.texels[i + c], 0.0f, 1.0f);
+
+            level.pixels[i + c] =
+                c < encoded
+                    ? encode[static_cast<int>(value * (linear_table_size - 1) + 0.5f)]
+                    : static_cast<unsigned char>(value * 255.0f + 0.5f);
+        }
+    }
+
+    return level;
+}
+
+// filter rows `first` to `last` of `source` horizontally into `out`
+void filter_horizontal(
+    float_image const& source,
+    int channels,
+    filter_kernel const& kernel,
+    float_image& out,
+    int first,
+    int last
+) {
+    auto const taps = static_cast<int>(kernel.weights.size());
+
+    for (int y = first; y < last; ++y) {
+        auto const *row = source.texels.data()
+                        + static_cast<std::size_t>(y) * source.width * channels;
+        auto *dst =
+            out.texels.data() + static_cast<std::size_t>(y) * out.width * channels;
+
+        for (int x = 0; x < out.width; ++x) {
+            auto const first_tap = 2 * x + kernel.offset;
+
+#if defined(__SSE2__)
+            // an RGBA texel is one register
+            if (channels == 4) {
+                auto sum = _mm_setzero_ps();
+
+                for (int i = 0; i < taps; ++i) {
+                    auto const sx = std::clamp(first_tap + i, 0, source.width - 1);
+                    auto const texel = _mm_loadu_ps(row + sx * 4);
+                    auto const weight = _mm_set1_ps(kernel.weights[i]);
+                    sum = _mm_add_ps(sum, _mm_mul_ps(weight, texel));
+                }
+
+                _mm_storeu_ps(dst + x * 4, sum);
+                continue;
+            }
+#endif
+
+            for (int c = 0; c < channels; ++c) {
+                auto sum = 0.0f;
+
+                for (int i = 0; i < taps; ++i) {
+                    auto const sx = std::clamp(first_tap + i, 0, source.width - 1);
+                    sum += kernel.weights[i] * row[sx * channels + c];
+                }
+
+                dst[x * channels + c] = sum;
+            }
+        }
+    }
+}
+
+// filter rows `first` to `last` of `out` vertically from `source`, whole
+// rows at a time so the inner loop vectorises
+void filter_vertical(
+    float_image const& source,
+    int channels,
+    filter_kernel const& kernel,
+    float_image& out,
+    int first,
+    int last
+) {
+    auto const row_size = static_cast<std::size_t>(out.width) * channels;
+    auto const taps = static_cast<int>(kernel.weights.size());
+
+    for (int y = first; y < last; ++y) {
+        auto *dst = out.texels.data() + y * row_size;
+        std::fill(dst, dst + row_size, 0.0f);
+
+        for (int i = 0; i < taps; ++i) {
+            auto const sy = std::clamp(2 * y + kernel.offset + i, 0, source.height - 1);
+            auto const *row = source.texels.data() + sy * row_size;
+            auto const weight = kernel.weights[i];
+
+            for (std::size_t j = 0; j < row_size; ++j) {
+                dst[j] += weight * row[j];
+            }
+        }
+    }
+}
+
+float_image filter_downsample(
+    float_image const& source,
+    int channels,
+    filter_kernel const& kernel,
+    unsigned int threads
+) {
+    auto const width = std::max(source.width / 2, 1);
+    auto const height = std::max(source.height / 2, 1);
+
+    auto columns = float_image{width, source.height, {}};
+    columns.texels.resize(static_cast<std::size_t>(width) * source.height * channels);
+
+    parallel_rows(source.height, threads, [&](int first, int last) {
+        filter_horizontal(source, channels, kernel, columns, first, last);
+    });
+
+    auto out = float_image{width, height, {}};
+    out.texels.resize(static_cast<std::size_t>(width) * height * channels);
+
+    parallel_rows(height, threads, [&](int first, int last) {
+        filter_vertical(columns, channels, kernel, out, first, last);
+    });
+
+    return out;
+}
+
+bool integer_path(mip_options const& options, int channels) {
+    return options.filter == mip_filter::box
+        && srgb_channels(channels, options.srgb) == 0;
+}
+
+} // namespace
+
+mip_level downsample(
+    unsigned char const *pixels,
+    int width,
+    int height,
+    int channels,
+    mip_options const& options
+) {
+    if (integer_path(options, channels)) {
+        return box_downsample(pixels, width, height, channels, options.threads);
+    }
+
+    auto const image = to_float(pixels, width, height, channels, options.srgb);
+    auto const kernel = make_kernel(options.filter);
+
+    return to_level(
+        filter_downsample(image, channels, kernel, options.threads),
+        channels,
+        options.srgb
+    );
+}
+
+std::vector<mip_level> build_mip_chain(
+    unsigned char const *pixels,
+    int width,
+    int height,
+    int channels,
+    mip_options const& options
+) {
+    auto levels = std::vector<mip_level>{};
+
+    if (integer_path(options, channels)) {
+        while (width > 1 || height > 1) {
+            levels.push_back(
+                box_downsample(pixels, width, height, channels, options.threads)
+            );
+            pixels = levels.back().pixels.data();
+            width = levels.back().width;
+            height = levels.back().height;
+        }
+
+        return levels;
+    }
+
+    auto const kernel = make_kernel(options.filter);
+    auto image = to_float(pixels, width, height, channels, options.srgb);
+
+    while (image.width > 1 || image.height > 1) {
+        image = filter_downsample(image, channels, kernel, options.threads);
+        levels.push_back(to_level(image, channels, options.srgb));
+    }
+
+    return levels;
+}
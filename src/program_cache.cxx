@@ -0,0 +1,208 @@
+#include <program_cache.h>
+
+#include <file_loader.h>
+#include <gl_ext.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace program_cache {
+
+namespace {
+
+// bumped whenever the entry layout below changes
+constexpr std::uint32_t cache_version = 1;
+
+struct entry_header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t key;
+    std::uint32_t format;
+    std::uint32_t length;
+};
+
+fs::path cache_directory = "shader_cache";
+bool cache_enabled = true;
+
+constexpr std::uint64_t fnv1a64(std::string_view str, std::uint64_t hash) {
+    for (char const c : str) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+// hash a length prefix before each string so that adjacent strings can't
+// alias, eg. ("ab", "c") and ("a", "bc")
+std::uint64_t hash_field(std::string_view str, std::uint64_t hash) {
+    auto const length = std::to_string(str.size());
+    return fnv1a64(str, fnv1a64(length, fnv1a64(":", hash)));
+}
+
+std::string_view gl_string(GLenum name) {
+    auto const *str = reinterpret_cast<char const *>(glGetString(name));
+    return str == NULL ? std::string_view{} : std::string_view{str};
+}
+
+bool supported() {
+    if (!cache_enabled || !GLEXT_ARB_get_program_binary) {
+        return false;
+    }
+
+    int formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+fs::path entry_path(std::uint64_t key) {
+    char name[32] = {0};
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return cache_directory / name;
+}
+
+} // namespace
+
+void set_directory(fs::path const& directory) {
+    cache_directory = directory;
+}
+
+fs::path const& directory() {
+    return cache_directory;
+}
+
+void set_enabled(bool enabled) {
+    cache_enabled = enabled;
+}
+
+std::uint64_t key(std::initializer_list<std::string_view> sources, std::string_view defines) {
+    std::uint64_t hash = 14695981039346656037ull;
+
+    hash = hash_field(gl_string(GL_VENDOR), hash);
+    hash = hash_field(gl_string(GL_RENDERER), hash);
+    hash = hash_field(gl_string(GL_VERSION), hash);
+    hash = hash_field(defines, hash);
+
+    for (auto const source : sources) {
+        hash = hash_field(source, hash);
+    }
+
+    return hash;
+}
+
+void prepare(unsigned int program) {
+    if (supported()) {
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
+
+bool load(unsigned int program, std::uint64_t key) {
+    if (!supported()) {
+        return false;
+    }
+
+    auto file = std::ifstream(entry_path(key), std::ios::binary);
+
+    if (!file) {
+        return false;
+    }
+
+    auto header = entry_header{};
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+
+    if (!file || std::string_view{header.magic, 4} != "LOGL"
+        || header.version != cache_version || header.key != key) {
+        return false;
+    }
+
+    // a corrupt length must not size the allocation below
+    auto ec = std::error_code{};
+    auto const size = fs::file_size(entry_path(key), ec);
+
+    if (ec || size < sizeof(header) || header.length > size - sizeof(header)) {
+        return false;
+    }
+
+    auto binary = std::vector<char>(header.length);
+    file.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+
+    if (!file) {
+        return false;
+    }
+
+    glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(header.length));
+
+    int success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    return success != 0;
+}
+
+void store(unsigned int program, std::uint64_t key) {
+    if (!supported()) {
+        return;
+    }
+
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+
+    if (length <= 0) {
+        return;
+    }
+
+    auto binary = std::vector<char>(static_cast<std::size_t>(length));
+    auto format = GLenum{0};
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+
+    auto ec = std::error_code{};
+    fs::create_directories(cache_directory, ec);
+
+    if (ec) {
+        std::cerr << "ERROR::PROGRAM_CACHE::CREATE_DIRECTORY_FAILED\n"
+                  << ec.message() << "\n";
+        return;
+    }
+
+    auto const header = entry_header{
+        {'L', 'O', 'G', 'L'},
+        cache_version,
+        key,
+        format,
+        static_cast<std::uint32_t>(length)
+    };
+
+    // write to a temporary first so concurrent launches never read a
+    // partially written entry
+    auto const path = entry_path(key);
+    auto const tmp_path = temporary_path(path);
+
+    {
+        auto file = std::ofstream(tmp_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<char const *>(&header), sizeof(header));
+        file.write(binary.data(), length);
+
+        if (!file) {
+            std::cerr << "ERROR::PROGRAM_CACHE::WRITE_FAILED\n" << tmp_path << "\n";
+            file.close();
+            fs::remove(tmp_path, ec);
+            return;
+        }
+    }
+
+    fs::rename(tmp_path, path, ec);
+
+    if (ec) {
+        fs::remove(tmp_path, ec);
+    }
+}
+
+} // namespace program_cache
@@ -0,0 +1,127 @@
+#include <program_pipeline.h>
+
+#include <gl_ext.h>
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+ProgramPipeline::ProgramPipeline(Shader const& vertex, Shader const& fragment)
+    : vertex_stage(&vertex), fragment_stage(&fragment) {
+    glGenProgramPipelines(1, &ID);
+    attach();
+}
+
+ProgramPipeline::~ProgramPipeline() {
+    glDeleteProgramPipelines(1, &ID);
+}
+
+ProgramPipeline::ProgramPipeline(ProgramPipeline&& other) noexcept
+    : ID(std::exchange(other.ID, 0)), vertex_stage(other.vertex_stage),
+      fragment_stage(other.fragment_stage), attached_vertex(other.attached_vertex),
+      attached_fragment(other.attached_fragment) {}
+
+ProgramPipeline& ProgramPipeline::operator=(ProgramPipeline&& other) noexcept {
+    if (this != &other) {
+        glDeleteProgramPipelines(1, &ID);
+
+        ID = std::exchange(other.ID, 0);
+        vertex_stage = other.vertex_stage;
+        fragment_stage = other.fragment_stage;
+        attached_vertex = other.attached_vertex;
+        attached_fragment = other.attached_fragment;
+    }
+
+    return *this;
+}
+
+bool ProgramPipeline::supported() {
+    return GLEXT_ARB_separate_shader_objects != 0;
+}
+
+void ProgramPipeline::attach() {
+    if (attached_vertex != vertex_stage->ID) {
+        glUseProgramStages(ID, GL_VERTEX_SHADER_BIT, vertex_stage->ID);
+        attached_vertex = vertex_stage->ID;
+    }
+
+    if (attached_fragment != fragment_stage->ID) {
+        glUseProgramStages(ID, GL_FRAGMENT_SHADER_BIT, fragment_stage->ID);
+        attached_fragment = fragment_stage->ID;
+    }
+}
+
+void ProgramPipeline::use() {
+    // a program bound with glUseProgram takes precedence over the pipeline
+    glUseProgram(0);
+    attach();
+    glBindProgramPipeline(ID);
+}
+
+void ProgramPipeline::activate(Shader const& stage) {
+    glActiveShaderProgram(ID, stage.ID);
+}
+
+bool ProgramPipeline::validate() {
+    attach();
+    glValidateProgramPipeline(ID);
+
+    int success = 0;
+    glGetProgramPipelineiv(ID, GL_VALIDATE_STATUS, &success);
+
+    if (!success) {
+        char info_log[512] = {0};
+        glGetProgramPipelineInfoLog(ID, 512, NULL, info_log);
+        std::cerr << "ERROR::SHADER::PIPELINE::VALIDATION_FAILED\n"
+                  << vertex_stage->vertex_path().string() << " + "
+                  << fragment_stage->fragment_path().string() << "\n"
+                  << info_log
+                  << "\n";
+    }
+
+    return success != 0;
+}
+
+Shader& StageCache::stage(
+    shader_stage kind,
+    std::string_view path,
+    shader_defines const& defines
+) {
+    auto key = permutation_key(defines);
+    auto const stage_path = std::filesystem::path(path);
+
+    for (std::size_t i = 0; i < stages.size(); ++i) {
+        if (stage_kinds[i] == kind && stage_paths[i] == stage_path
+            && stage_keys[i] == key) {
+            return stages[i];
+        }
+    }
+
+    stage_kinds.push_back(kind);
+    stage_paths.push_back(stage_path);
+    stage_keys.push_back(std::move(key));
+    return stages.emplace_back(kind, path, defines);
+}
+
+ProgramPipeline& StageCache::pipeline(Shader const& vertex, Shader const& fragment) {
+    for (auto& pipeline : pipelines) {
+        if (&pipeline.vertex() == &vertex && &pipeline.fragment() == &fragment) {
+            return pipeline;
+        }
+    }
+
+    return pipelines.emplace_back(vertex, fragment);
+}
+
+ProgramPipeline& StageCache::pipeline(
+    std::string_view vertex_path,
+    std::string_view frag_path,
+    shader_defines const& defines
+) {
+    auto const& vertex = stage(shader_stage::vertex, vertex_path, defines);
+    auto const& fragment = stage(shader_stage::fragment, frag_path, defines);
+    return pipeline(vertex, fragment);
+}
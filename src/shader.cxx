@@ -1,200 +1,822 @@
 #include <shader.h>
 
+#include <file_loader.h>
+#include <gl_ext.h>
+#include <program_cache.h>
+#include <program_pipeline.h>
+#include <startup_trace.h>
+
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-#include <fstream>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <filesystem>
 #include <iostream>
-#include <sstream>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+bool is_sampler_type(unsigned int type) {
+    switch (type) {
+        case GL_SAMPLER_1D:
+        case GL_SAMPLER_2D:
+        case GL_SAMPLER_3D:
+        case GL_SAMPLER_CUBE:
+        case GL_SAMPLER_1D_SHADOW:
+        case GL_SAMPLER_2D_SHADOW:
+        case GL_SAMPLER_1D_ARRAY:
+        case GL_SAMPLER_2D_ARRAY:
+        case GL_SAMPLER_1D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_ARRAY_SHADOW:
+        case GL_SAMPLER_2D_MULTISAMPLE:
+        case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_SAMPLER_CUBE_SHADOW:
+        case GL_SAMPLER_BUFFER:
+        case GL_SAMPLER_2D_RECT:
+        case GL_SAMPLER_2D_RECT_SHADOW:
+        case GL_INT_SAMPLER_1D:
+        case GL_INT_SAMPLER_2D:
+        case GL_INT_SAMPLER_3D:
+        case GL_INT_SAMPLER_CUBE:
+        case GL_INT_SAMPLER_1D_ARRAY:
+        case GL_INT_SAMPLER_2D_ARRAY:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_INT_SAMPLER_BUFFER:
+        case GL_INT_SAMPLER_2D_RECT:
+        case GL_UNSIGNED_INT_SAMPLER_1D:
+        case GL_UNSIGNED_INT_SAMPLER_2D:
+        case GL_UNSIGNED_INT_SAMPLER_3D:
+        case GL_UNSIGNED_INT_SAMPLER_CUBE:
+        case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+        case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+        case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// components of a scalar or vector attribute type, 0 for anything else
+int component_count(unsigned int type) {
+    switch (type) {
+        case GL_FLOAT:
+        case GL_INT:
+        case GL_UNSIGNED_INT:
+            return 1;
+        case GL_FLOAT_VEC2:
+        case GL_INT_VEC2:
+        case GL_UNSIGNED_INT_VEC2:
+            return 2;
+        case GL_FLOAT_VEC3:
+        case GL_INT_VEC3:
+        case GL_UNSIGNED_INT_VEC3:
+            return 3;
+        case GL_FLOAT_VEC4:
+        case GL_INT_VEC4:
+        case GL_UNSIGNED_INT_VEC4:
+            return 4;
+        default:
+            return 0;
+    }
+}
 
-namespace fs = std::filesystem;
+} // namespace
 
-Shader::Shader(std::string_view vertex_path, std::string_view fragment_path) {
-    auto const ex_bits = std::ifstream::failbit | std::ifstream::badbit;
-    auto const vert_path = fs::path(vertex_path);
-    auto const frag_path = fs::path(fragment_path);
+Shader::Shader(
+    std::string_view vertex_path,
+    std::string_view fragment_path,
+    shader_defines defines,
+    compile_mode mode
+) : vert_path(vertex_path), frag_path(fragment_path), program_defines(std::move(defines)) {
+    auto const sources = read_sources();
+    submit(sources.vertex, sources.fragment);
 
-    auto vert_file = std::ifstream(vert_path);
-    auto frag_file = std::ifstream(frag_path);
+    if (mode == compile_mode::immediate) {
+        finish();
+    }
+}
 
-    auto vertex_shader = std::string{};
-    auto fragment_shader = std::string{};
+Shader::Shader(
+    shader_stage stage,
+    std::string_view path,
+    shader_defines defines,
+    compile_mode mode
+) : program_defines(std::move(defines)), is_separable(true) {
+    if (stage == shader_stage::vertex) {
+        vert_path = path;
+    } else {
+        frag_path = path;
+    }
 
-    try {
-        vert_file.exceptions(ex_bits);
-        frag_file.exceptions(ex_bits);
+    auto const sources = read_sources();
+    submit(sources.vertex, sources.fragment);
 
-        auto vert_stream = std::stringstream{};
-        auto frag_stream = std::stringstream{};
+    if (mode == compile_mode::immediate) {
+        finish();
+    }
+}
 
-        vert_stream << vert_file.rdbuf();
-        frag_stream << frag_file.rdbuf();
+shader_sources Shader::read_sources() const {
+    auto const trace = startup_trace::scope(
+        "read shader " + vert_path.string() + " + " + frag_path.string()
+    );
 
-        vert_file.close();
-        frag_file.close();
+    // both stages are read in one pass, includes are read by the preprocessor.
+    // The missing stage of a separable program is read as empty
+    auto paths = std::vector<std::filesystem::path>{};
 
-        vertex_shader = vert_stream.str();
-        fragment_shader = frag_stream.str();
-    } catch (std::ifstream::failure const& ex) {
-        std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << std::endl;
+    for (auto const& path : {vert_path, frag_path}) {
+        if (!path.empty()) {
+            paths.push_back(path);
+        }
+    }
+
+    auto files = read_files(paths);
+
+    if (vert_path.empty()) {
+        files.insert(files.begin(), loaded_file{{}, {}, true});
+    } else if (frag_path.empty()) {
+        files.push_back(loaded_file{{}, {}, true});
+    }
+
+    for (auto const& file : files) {
+        if (!file.ok) {
+            std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ\n"
+                      << file.path.string() << "\n";
+        }
+    }
+
+    auto sources = shader_sources{};
+
+    if (!vert_path.empty()) {
+        sources.vertex = preprocess_shader(
+            vert_path,
+            files[0].contents,
+            program_defines,
+            &sources.dependencies
+        );
+    }
+
+    if (!frag_path.empty()) {
+        sources.fragment = preprocess_shader(
+            frag_path,
+            files[1].contents,
+            program_defines,
+            &sources.dependencies
+        );
+    }
+
+    return sources;
+}
+
+void Shader::submit(std::string const& vertex_shader, std::string const& fragment_shader) {
+    // a separable program links differently, keep it apart in the cache
+    cache_key = program_cache::key(
+        {vertex_shader, fragment_shader, is_separable ? "separable" : ""},
+        permutation_key(program_defines)
+    );
+    ID = glCreateProgram();
+
+    // the program stays unlinked, `finish` then reports failure
+    if (is_separable && !ProgramPipeline::supported()) {
+        std::cerr << "ERROR::SHADER::SEPARABLE_UNSUPPORTED\n"
+                  << (vert_path.empty() ? frag_path : vert_path).string() << "\n";
+        return;
+    }
+
+    if (is_separable) {
+        glProgramParameteri(ID, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    }
+
+    if (program_cache::load(ID, cache_key)) {
+        linked = true;
+        reflect();
+        return;
     }
 
     const char *vert_shader_cstr = vertex_shader.c_str();
     const char *frag_shader_cstr = fragment_shader.c_str();
+
+    // status is only queried in `finish` so the driver is free to compile
+    // and link in the background
+    if (!vert_path.empty()) {
+        pending_vertex = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(pending_vertex, 1, &vert_shader_cstr, NULL);
+        glCompileShader(pending_vertex);
+        glAttachShader(ID, pending_vertex);
+    }
+
+    if (!frag_path.empty()) {
+        pending_fragment = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(pending_fragment, 1, &frag_shader_cstr, NULL);
+        glCompileShader(pending_fragment);
+        glAttachShader(ID, pending_fragment);
+    }
+
+    program_cache::prepare(ID);
+    glLinkProgram(ID);
+    pending = true;
+}
+
+bool Shader::reload(std::string const& vertex_shader, std::string const& fragment_shader) {
+    finish();
+
+    auto const previous = ID;
+    auto const previous_key = cache_key;
+    auto const previous_linked = linked;
+
+    submit(vertex_shader, fragment_shader);
+
+    if (!finish()) {
+        glDeleteProgram(ID);
+        ID = previous;
+        cache_key = previous_key;
+        linked = previous_linked;
+        reflect();
+        return false;
+    }
+
+    glDeleteProgram(previous);
+
+    // block bindings are per-program state, restore them on the new program
+    for (std::size_t i = 0; i < block_names.size(); ++i) {
+        bind_uniform_block(block_names[i], block_bindings[i]);
+    }
+
+    return true;
+}
+
+Shader::~Shader() {
+    glDeleteShader(pending_vertex);
+    glDeleteShader(pending_fragment);
+    glDeleteProgram(ID);
+}
+
+Shader::Shader(Shader&& other) noexcept
+    : ID(std::exchange(other.ID, 0)), vert_path(std::move(other.vert_path)),
+      frag_path(std::move(other.frag_path)),
+      program_defines(std::move(other.program_defines)),
+      is_separable(other.is_separable), uniform_infos(std::move(other.uniform_infos)),
+      uniform_hashes(std::move(other.uniform_hashes)),
+      uniform_locations(std::move(other.uniform_locations)),
+      uniform_shadows(std::move(other.uniform_shadows)),
+      upload_stats(other.upload_stats),
+      attribute_infos(std::move(other.attribute_infos)),
+      block_infos(std::move(other.block_infos)),
+      block_names(std::move(other.block_names)),
+      block_bindings(std::move(other.block_bindings)),
+      pending_vertex(std::exchange(other.pending_vertex, 0)),
+      pending_fragment(std::exchange(other.pending_fragment, 0)),
+      cache_key(other.cache_key), pending(std::exchange(other.pending, false)),
+      linked(other.linked) {}
+
+Shader& Shader::operator=(Shader&& other) noexcept {
+    if (this != &other) {
+        glDeleteShader(pending_vertex);
+        glDeleteShader(pending_fragment);
+        glDeleteProgram(ID);
+
+        ID = std::exchange(other.ID, 0);
+        vert_path = std::move(other.vert_path);
+        frag_path = std::move(other.frag_path);
+        program_defines = std::move(other.program_defines);
+        is_separable = other.is_separable;
+        uniform_infos = std::move(other.uniform_infos);
+        uniform_hashes = std::move(other.uniform_hashes);
+        uniform_locations = std::move(other.uniform_locations);
+        uniform_shadows = std::move(other.uniform_shadows);
+        upload_stats = other.upload_stats;
+        attribute_infos = std::move(other.attribute_infos);
+        block_infos = std::move(other.block_infos);
+        block_names = std::move(other.block_names);
+        block_bindings = std::move(other.block_bindings);
+        pending_vertex = std::exchange(other.pending_vertex, 0);
+        pending_fragment = std::exchange(other.pending_fragment, 0);
+        cache_key = other.cache_key;
+        pending = std::exchange(other.pending, false);
+        linked = other.linked;
+    }
+
+    return *this;
+}
+
+bool Shader::ready() const {
+    if (!pending || !GLEXT_KHR_parallel_shader_compile) {
+        return true;
+    }
+
+    int complete = 0;
+    glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &complete);
+    return complete != 0;
+}
+
+bool Shader::finish() {
+    if (!pending) {
+        return linked;
+    }
+
     char info_log[512] = {0};
     int success = 0;
 
-    unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vert_shader_cstr, NULL);
-    glCompileShader(vertex);
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+    // a separable program has no shader object for its missing stage
+    success = pending_vertex == 0;
+
+    if (!success) {
+        glGetShaderiv(pending_vertex, GL_COMPILE_STATUS, &success);
+    }
 
     if (!success) {
-        glGetShaderInfoLog(vertex, 512, NULL, info_log);
+        glGetShaderInfoLog(pending_vertex, 512, NULL, info_log);
         std::cerr << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n"
                   << info_log
                   << "\n";
     }
 
-    unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &frag_shader_cstr, NULL);
-    glCompileShader(fragment);
-    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
+    success = pending_fragment == 0;
+
+    if (!success) {
+        glGetShaderiv(pending_fragment, GL_COMPILE_STATUS, &success);
+    }
 
     if (!success) {
-        glGetShaderInfoLog(fragment, 512, NULL, info_log);
+        glGetShaderInfoLog(pending_fragment, 512, NULL, info_log);
         std::cerr << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n"
                   << info_log
                   << "\n";
     }
 
-    ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
-    glLinkProgram(ID);
     glGetProgramiv(ID, GL_LINK_STATUS, &success);
+    linked = success != 0;
 
-    if (!success) {
+    if (!linked) {
         glGetProgramInfoLog(ID, 512, NULL, info_log);
         std::cerr << "ERROR::SHADER::PROGRAM::LINK_FAILED\n"
                   << info_log
                   << "\n";
+    } else {
+        program_cache::store(ID, cache_key);
     }
 
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
-}
+    glDeleteShader(pending_vertex);
+    glDeleteShader(pending_fragment);
+    pending_vertex = 0;
+    pending_fragment = 0;
+    pending = false;
 
-Shader::~Shader() {
-    glDeleteProgram(ID);
+    reflect();
+    return linked;
 }
 
 void Shader::use() {
     glUseProgram(ID);
 }
 
+void Shader::reflect() {
+    reflect_uniforms();
+    reflect_attributes();
+    reflect_uniform_blocks();
+    assign_sampler_units();
+}
+
+void Shader::reflect_uniforms() {
+    int count = 0;
+    int max_length = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+    // slots of uniforms seen before are kept so that handles stay valid
+    // across `reload`, uniforms that are no longer active map to -1
+    std::fill(uniform_locations.begin(), uniform_locations.end(), -1);
+
+    // a new program starts from default values, so nothing is known about
+    // what is currently uploaded
+    for (auto& shadow : uniform_shadows) {
+        shadow.size = 0;
+    }
+
+    for (auto& info : uniform_infos) {
+        info.location = -1;
+    }
+
+    auto name = std::string(static_cast<std::size_t>(max_length), '\0');
+
+    for (int i = 0; i < count; ++i) {
+        int length = 0;
+        int size = 0;
+        unsigned int type = 0;
+        glGetActiveUniform(ID, i, max_length, &length, &size, &type, name.data());
+
+        auto uniform_name = name.substr(0, static_cast<std::size_t>(length));
+        int const loc = glGetUniformLocation(ID, uniform_name.c_str());
+
+        // uniforms inside named blocks have no location
+        if (loc < 0) {
+            continue;
+        }
+
+        // arrays are reported as "name[0]", cache them under the base name
+        if (auto const pos = uniform_name.find("[0]"); pos != std::string::npos) {
+            uniform_name.erase(pos);
+        }
+
+        auto const hash = fnv1a(uniform_name);
+        auto const existing = uniform(uniform_name);
+
+        if (existing.index >= 0) {
+            auto& info = uniform_infos[existing.index];
+
+            // a sampler that changed type or size gets a fresh unit
+            if (info.type != type || info.size != size) {
+                info.unit = -1;
+            }
+
+            info.location = loc;
+            info.type = type;
+            info.size = size;
+            uniform_locations[existing.index] = loc;
+            continue;
+        }
+
+        for (std::size_t j = 0; j < uniform_hashes.size(); ++j) {
+            if (uniform_hashes[j] == hash) {
+                std::cerr << "WARNING::SHADER::UNIFORM_HASH_COLLISION\n"
+                          << uniform_infos[j].name << " and " << uniform_name << "\n";
+            }
+        }
+
+        uniform_infos.push_back(uniform_info{std::move(uniform_name), loc, type, size, -1});
+        uniform_hashes.push_back(hash);
+        uniform_locations.push_back(loc);
+        uniform_shadows.push_back(uniform_shadow{});
+    }
+}
+
+void Shader::reflect_attributes() {
+    int count = 0;
+    int max_length = 0;
+    glGetProgramiv(ID, GL_ACTIVE_ATTRIBUTES, &count);
+    glGetProgramiv(ID, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &max_length);
+
+    attribute_infos.clear();
+
+    auto name = std::string(static_cast<std::size_t>(max_length), '\0');
+
+    for (int i = 0; i < count; ++i) {
+        int length = 0;
+        int size = 0;
+        unsigned int type = 0;
+        glGetActiveAttrib(ID, i, max_length, &length, &size, &type, name.data());
+
+        auto attribute_name = name.substr(0, static_cast<std::size_t>(length));
+        int const loc = glGetAttribLocation(ID, attribute_name.c_str());
+
+        // built-ins such as gl_VertexID have no location
+        if (loc < 0) {
+            continue;
+        }
+
+        attribute_infos.push_back(attribute_info{std::move(attribute_name), loc, type, size});
+    }
+}
+
+void Shader::reflect_uniform_blocks() {
+    int count = 0;
+    int max_length = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &max_length);
+
+    block_infos.clear();
+
+    auto name = std::string(static_cast<std::size_t>(max_length), '\0');
+
+    for (int i = 0; i < count; ++i) {
+        auto const index = static_cast<unsigned int>(i);
+        int length = 0;
+        int data_size = 0;
+        int binding = 0;
+        glGetActiveUniformBlockName(ID, index, max_length, &length, name.data());
+        glGetActiveUniformBlockiv(ID, index, GL_UNIFORM_BLOCK_DATA_SIZE, &data_size);
+        glGetActiveUniformBlockiv(ID, index, GL_UNIFORM_BLOCK_BINDING, &binding);
+
+        block_infos.push_back(uniform_block_info{
+            name.substr(0, static_cast<std::size_t>(length)),
+            index,
+            data_size,
+            static_cast<unsigned int>(binding)
+        });
+    }
+}
+
+void Shader::assign_sampler_units() {
+    // units kept from a previous link are reserved first
+    int next_unit = 0;
+
+    for (auto const& info : uniform_infos) {
+        if (info.location >= 0 && info.unit >= 0) {
+            next_unit = std::max(next_unit, info.unit + info.size);
+        }
+    }
+
+    auto samplers = std::vector<std::size_t>{};
+
+    for (std::size_t i = 0; i < uniform_infos.size(); ++i) {
+        if (uniform_infos[i].location >= 0 && is_sampler_type(uniform_infos[i].type)) {
+            samplers.push_back(i);
+        }
+    }
+
+    if (samplers.empty()) {
+        return;
+    }
+
+    // GL 3.3 has no glProgramUniform, so the program is bound temporarily
+    int previous = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &previous);
+    glUseProgram(ID);
+
+    for (auto const i : samplers) {
+        auto& info = uniform_infos[i];
+
+        if (info.unit < 0) {
+            info.unit = next_unit;
+            next_unit += info.size;
+        }
+
+        auto units = std::vector<int>(static_cast<std::size_t>(info.size));
+
+        for (int j = 0; j < info.size; ++j) {
+            units[j] = info.unit + j;
+        }
+
+        glUniform1iv(info.location, info.size, units.data());
+    }
+
+    glUseProgram(static_cast<unsigned int>(previous));
+}
+
+int Shader::sampler_unit(std::string_view name) const {
+    return sampler_unit(uniform(name));
+}
+
+int Shader::sampler_unit(uniform_handle handle) const {
+    if (handle.index < 0 || uniform_infos[handle.index].location < 0) {
+        return -1;
+    }
+
+    return uniform_infos[handle.index].unit;
+}
+
+bool Shader::validate_vertex_layout(std::vector<vertex_attribute> const& layout) const {
+    auto valid = true;
+
+    for (auto const& attribute : attribute_infos) {
+        auto const components = component_count(attribute.type);
+        auto fed = false;
+
+        for (auto const& input : layout) {
+            if (input.location != attribute.location) {
+                continue;
+            }
+
+            fed = true;
+
+            // matrices and other multi-slot inputs are not checked
+            if (components > 0 && input.components != components) {
+                std::cerr << "ERROR::SHADER::VERTEX_LAYOUT::COMPONENT_MISMATCH\n"
+                          << attribute.name << " at location " << attribute.location
+                          << " expects " << components << " components, got "
+                          << input.components << "\n";
+                valid = false;
+            }
+        }
+
+        if (!fed) {
+            std::cerr << "ERROR::SHADER::VERTEX_LAYOUT::MISSING_ATTRIBUTE\n"
+                      << attribute.name << " at location " << attribute.location << "\n";
+            valid = false;
+        }
+    }
+
+    return valid;
+}
+
+uniform_handle Shader::uniform(std::string_view name) const {
+    auto const hash = fnv1a(name);
+
+    for (std::size_t i = 0; i < uniform_hashes.size(); ++i) {
+        if (uniform_hashes[i] == hash && uniform_infos[i].name == name) {
+            return uniform_handle{static_cast<int>(i)};
+        }
+    }
+
+    return uniform_handle{};
+}
+
+uniform_handle Shader::uniform(uniform_id id) const {
+    for (std::size_t i = 0; i < uniform_hashes.size(); ++i) {
+        if (uniform_hashes[i] == id.hash) {
+            return uniform_handle{static_cast<int>(i)};
+        }
+    }
+
+    return uniform_handle{};
+}
+
+int Shader::location(uniform_handle handle) const {
+    return handle.index < 0 ? -1 : uniform_locations[handle.index];
+}
+
+bool Shader::changed(uniform_handle handle, void const *data, std::size_t size) const {
+    if (location(handle) < 0) {
+        return false;
+    }
+
+    auto& shadow = uniform_shadows[handle.index];
+
+    if (shadow.size == size && std::memcmp(shadow.data.data(), data, size) == 0) {
+        ++upload_stats.skipped;
+        return false;
+    }
+
+    std::memcpy(shadow.data.data(), data, size);
+    shadow.size = static_cast<unsigned char>(size);
+    ++upload_stats.issued;
+    return true;
+}
+
+bool Shader::bind_uniform_block(std::string_view name, unsigned int binding) {
+    auto block_name = std::string(name);
+    unsigned int const index = glGetUniformBlockIndex(ID, block_name.c_str());
+
+    auto found = false;
+
+    for (std::size_t i = 0; i < block_names.size(); ++i) {
+        if (block_names[i] == name) {
+            block_bindings[i] = binding;
+            found = true;
+        }
+    }
+
+    if (!found) {
+        block_names.push_back(std::move(block_name));
+        block_bindings.push_back(binding);
+    }
+
+    if (index == GL_INVALID_INDEX) {
+        return false;
+    }
+
+    glUniformBlockBinding(ID, index, binding);
+
+    for (auto& info : block_infos) {
+        if (info.index == index) {
+            info.binding = binding;
+        }
+    }
+
+    return true;
+}
+
 template <>
-void Shader::set_uniform<bool>(std::string const& name, bool const& value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), static_cast<int>(value));
+void Shader::set_uniform<bool>(uniform_handle handle, bool const& value) const {
+    int const data = static_cast<int>(value);
+
+    if (changed(handle, &data, sizeof(data))) {
+        glUniform1i(location(handle), data);
+    }
 }
 
 template <>
-void Shader::set_uniform<int>(std::string const& name, int const& value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+void Shader::set_uniform<int>(uniform_handle handle, int const& value) const {
+    if (changed(handle, &value, sizeof(value))) {
+        glUniform1i(location(handle), value);
+    }
 }
 
 template <>
-void Shader::set_uniform<float>(std::string const& name, float const& value) const {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+void Shader::set_uniform<float>(uniform_handle handle, float const& value) const {
+    if (changed(handle, &value, sizeof(value))) {
+        glUniform1f(location(handle), value);
+    }
 }
 
 template <>
 void Shader::set_uniform<glm::vec2>(
-    std::string const& name,
+    uniform_handle handle,
     glm::vec2 const& vec
 ) const {
-    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(vec));
+    if (changed(handle, glm::value_ptr(vec), sizeof(vec))) {
+        glUniform2fv(location(handle), 1, glm::value_ptr(vec));
+    }
 }
 
 template <>
 void Shader::set_uniform<float>(
-    std::string const& name,
+    uniform_handle handle,
     float const x,
     float const y
 ) const {
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+    float const data[] = {x, y};
+
+    if (changed(handle, data, sizeof(data))) {
+        glUniform2f(location(handle), x, y);
+    }
 }
 
 template <>
 void Shader::set_uniform<glm::vec3>(
-    std::string const& name,
+    uniform_handle handle,
     glm::vec3 const& vec
 ) const {
-    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(vec));
+    if (changed(handle, glm::value_ptr(vec), sizeof(vec))) {
+        glUniform3fv(location(handle), 1, glm::value_ptr(vec));
+    }
 }
 
 template <>
 void Shader::set_uniform<float>(
-    std::string const& name,
+    uniform_handle handle,
     float const x,
     float const y,
     float const z
 ) const {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+    float const data[] = {x, y, z};
+
+    if (changed(handle, data, sizeof(data))) {
+        glUniform3f(location(handle), x, y, z);
+    }
 }
 
 template <>
 void Shader::set_uniform<glm::vec4>(
-    std::string const& name,
+    uniform_handle handle,
     glm::vec4 const& vec)
 const {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(vec));
+    if (changed(handle, glm::value_ptr(vec), sizeof(vec))) {
+        glUniform4fv(location(handle), 1, glm::value_ptr(vec));
+    }
 }
 
 template <>
 void Shader::set_uniform<float>(
-    std::string const& name,
+    uniform_handle handle,
     float const x,
     float const y,
     float const z,
     float const w
 ) const {
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+    float const data[] = {x, y, z, w};
+
+    if (changed(handle, data, sizeof(data))) {
+        glUniform4f(location(handle), x, y, z, w);
+    }
 }
 
 template <>
 void Shader::set_uniform<glm::mat2>(
-    std::string const& name,
+    uniform_handle handle,
     glm::mat2 const& matrix
 ) const {
-    glUniformMatrix2fv(
-        glGetUniformLocation(ID, name.c_str()),
-        1,
-        GL_FALSE,
-        glm::value_ptr(matrix)
-    );
+    if (changed(handle, glm::value_ptr(matrix), sizeof(matrix))) {
+        glUniformMatrix2fv(
+            location(handle),
+            1,
+            GL_FALSE,
+            glm::value_ptr(matrix)
+        );
+    }
 }
 
 template <>
-void Shader::set_uniform<glm::mat3>(std::string const& name, glm::mat3 const& matrix) const {
-    glUniformMatrix3fv(
-        glGetUniformLocation(ID, name.c_str()),
-        1,
-        GL_FALSE,
-        glm::value_ptr(matrix)
-    );
+void Shader::set_uniform<glm::mat3>(uniform_handle handle, glm::mat3 const& matrix) const {
+    if (changed(handle, glm::value_ptr(matrix), sizeof(matrix))) {
+        glUniformMatrix3fv(
+            location(handle),
+            1,
+            GL_FALSE,
+            glm::value_ptr(matrix)
+        );
+    }
 }
 
 template <>
-void Shader::set_uniform<glm::mat4>(std::string const& name, glm::mat4 const& matrix) const {
-    glUniformMatrix4fv(
-        glGetUniformLocation(ID, name.c_str()),
-        1,
-        GL_FALSE,
-        glm::value_ptr(matrix)
-    );
+void Shader::set_uniform<glm::mat4>(uniform_handle handle, glm::mat4 const& matrix) const {
+    if (changed(handle, glm::value_ptr(matrix), sizeof(matrix))) {
+        glUniformMatrix4fv(
+            location(handle),
+            1,
+            GL_FALSE,
+            glm::value_ptr(matrix)
+        );
+    }
 }
 
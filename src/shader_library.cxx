@@ -0,0 +1,110 @@
+#include <shader_library.h>
+
+#include <gl_ext.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+ShaderLibrary::ShaderLibrary() {
+    // let the driver pick its own worker count
+    if (GLEXT_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+}
+
+void ShaderLibrary::add(
+    std::string name,
+    std::string_view vertex_path,
+    std::string_view frag_path,
+    shader_defines const& defines
+) {
+    auto key = permutation_key(defines);
+
+    if (find(name, key) >= 0) {
+        return;
+    }
+
+    names.push_back(std::move(name));
+    keys.push_back(std::move(key));
+    shaders.emplace_back(vertex_path, frag_path, defines, compile_mode::deferred);
+}
+
+void ShaderLibrary::request(std::string_view name, shader_defines const& defines) {
+    auto key = permutation_key(defines);
+
+    if (find(name, key) >= 0) {
+        return;
+    }
+
+    // any permutation of `name` knows the source paths
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == name) {
+            auto const vertex_path = shaders[i].vertex_path().string();
+            auto const frag_path = shaders[i].fragment_path().string();
+
+            names.emplace_back(name);
+            keys.push_back(std::move(key));
+            shaders.emplace_back(vertex_path, frag_path, defines, compile_mode::deferred);
+            return;
+        }
+    }
+
+    throw std::out_of_range("ShaderLibrary: unknown program " + std::string(name));
+}
+
+std::size_t ShaderLibrary::poll() {
+    std::size_t remaining = 0;
+
+    for (auto& shader : shaders) {
+        if (!shader.compiling()) {
+            continue;
+        }
+
+        // without the extension `ready` is always true, so finishing here
+        // blocks; callers that poll in a loading loop still make progress
+        if (shader.ready()) {
+            shader.finish();
+        } else {
+            ++remaining;
+        }
+    }
+
+    return remaining;
+}
+
+void ShaderLibrary::wait() {
+    for (auto& shader : shaders) {
+        shader.finish();
+    }
+}
+
+std::size_t ShaderLibrary::ready_count() const {
+    std::size_t count = 0;
+
+    for (auto const& shader : shaders) {
+        count += shader.compiling() ? 0 : 1;
+    }
+
+    return count;
+}
+
+Shader& ShaderLibrary::get(std::string_view name, shader_defines const& defines) {
+    request(name, defines);
+
+    auto& shader = shaders[find(name, permutation_key(defines))];
+    shader.finish();
+    return shader;
+}
+
+int ShaderLibrary::find(std::string_view name, std::string_view key) const {
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == name && keys[i] == key) {
+            return static_cast<int>(i);
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,240 @@
+#include <shader_preprocessor.h>
+
+#include <file_loader.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct preprocess_context {
+    shader_defines const& defines;
+    std::vector<fs::path> files;
+    std::string out;
+};
+
+std::string_view trim_start(std::string_view str) {
+    auto const pos = str.find_first_not_of(" \t");
+    return pos == std::string_view::npos ? std::string_view{} : str.substr(pos);
+}
+
+bool is_directive(std::string_view line, std::string_view directive) {
+    line = trim_start(line);
+
+    if (line.empty() || line.front() != '#') {
+        return false;
+    }
+
+    return trim_start(line.substr(1)).substr(0, directive.size()) == directive;
+}
+
+// true if `line` holds nothing but whitespace and comments, `in_comment`
+// carries an unterminated block comment over to the next line
+bool is_blank_or_comment(std::string_view line, bool& in_comment) {
+    while (true) {
+        if (in_comment) {
+            auto const close = line.find("*/");
+
+            if (close == std::string_view::npos) {
+                return true;
+            }
+
+            line = line.substr(close + 2);
+            in_comment = false;
+        }
+
+        auto const pos = line.find_first_not_of(" \t\r");
+        line = pos == std::string_view::npos ? std::string_view{} : line.substr(pos);
+
+        if (line.empty() || line.substr(0, 2) == "//") {
+            return true;
+        }
+
+        if (line.substr(0, 2) != "/*") {
+            return false;
+        }
+
+        line = line.substr(2);
+        in_comment = true;
+    }
+}
+
+void inject_defines(preprocess_context& ctx) {
+    for (auto const& define : ctx.defines) {
+        ctx.out += "#define ";
+        ctx.out += define.name;
+
+        if (!define.value.empty()) {
+            ctx.out += ' ';
+            ctx.out += define.value;
+        }
+
+        ctx.out += '\n';
+    }
+}
+
+// restore the line numbering of file `index` so compiler errors point at
+// the right place, `line` is the number of the next line
+void line_directive(preprocess_context& ctx, std::size_t line, std::size_t index) {
+    ctx.out += "#line " + std::to_string(line) + " " + std::to_string(index) + "\n";
+}
+
+// `preloaded` is the contents of `path` if the caller already read it
+void expand(
+    fs::path const& path,
+    std::string const *preloaded,
+    preprocess_context& ctx,
+    bool root
+) {
+    auto const file_path = fs::absolute(path).lexically_normal();
+
+    if (std::find(ctx.files.begin(), ctx.files.end(), file_path) != ctx.files.end()) {
+        return;
+    }
+
+    auto const index = ctx.files.size();
+    ctx.files.push_back(file_path);
+
+    auto loaded = std::string{};
+
+    if (preloaded == nullptr && !read_file(file_path, loaded)) {
+        std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ\n" << file_path.string() << "\n";
+        return;
+    }
+
+    auto const& source = preloaded == nullptr ? loaded : *preloaded;
+
+    if (!root) {
+        line_directive(ctx, 1, index);
+    }
+
+    auto injected = !root;
+    auto in_comment = false;
+    auto remaining = std::string_view{source};
+    std::size_t line_number = 0;
+
+    while (!remaining.empty()) {
+        auto const end = remaining.find('\n');
+        auto const line = remaining.substr(0, end);
+        remaining = end == std::string_view::npos ? std::string_view{}
+                                                  : remaining.substr(end + 1);
+        ++line_number;
+
+        // only the root file may declare the version, blank it out in
+        // includes to keep the line numbering intact
+        if (is_directive(line, "version")) {
+            if (!root) {
+                ctx.out += '\n';
+                continue;
+            }
+
+            ctx.out += line;
+            ctx.out += '\n';
+
+            if (!injected) {
+                inject_defines(ctx);
+                line_directive(ctx, line_number + 1, index);
+                injected = true;
+            }
+
+            continue;
+        }
+
+        // comments and blank lines may precede `#version`, which has to stay
+        // the first statement
+        if (!injected && is_blank_or_comment(line, in_comment)) {
+            ctx.out += line;
+            ctx.out += '\n';
+            continue;
+        }
+
+        if (!injected) {
+            inject_defines(ctx);
+            line_directive(ctx, line_number, index);
+            injected = true;
+        }
+
+        if (is_directive(line, "include")) {
+            auto const open = line.find('"');
+            auto const close = open == std::string_view::npos ? open : line.find('"', open + 1);
+
+            if (close == std::string_view::npos) {
+                std::cerr << "ERROR::SHADER::MALFORMED_INCLUDE\n"
+                          << file_path.string() << ":" << line_number << "\n";
+            } else {
+                auto const name = line.substr(open + 1, close - open - 1);
+                expand(file_path.parent_path() / name, nullptr, ctx, false);
+            }
+
+            line_directive(ctx, line_number + 1, index);
+            continue;
+        }
+
+        ctx.out += line;
+        ctx.out += '\n';
+    }
+}
+
+} // namespace
+
+std::string permutation_key(shader_defines const& defines) {
+    auto sorted = defines;
+    std::sort(sorted.begin(), sorted.end(), [](auto const& lhs, auto const& rhs) {
+        return lhs.name < rhs.name;
+    });
+
+    auto key = std::string{};
+
+    for (auto const& define : sorted) {
+        if (!key.empty()) {
+            key += ';';
+        }
+
+        key += define.name;
+
+        if (!define.value.empty()) {
+            key += '=';
+            key += define.value;
+        }
+    }
+
+    return key;
+}
+
+std::string preprocess_shader(
+    fs::path const& path,
+    shader_defines const& defines,
+    std::vector<fs::path> *dependencies
+) {
+    auto ctx = preprocess_context{defines, {}, {}};
+    expand(path, nullptr, ctx, true);
+
+    if (dependencies != nullptr) {
+        dependencies->insert(dependencies->end(), ctx.files.begin(), ctx.files.end());
+    }
+
+    return ctx.out;
+}
+
+std::string preprocess_shader(
+    fs::path const& path,
+    std::string const& source,
+    shader_defines const& defines,
+    std::vector<fs::path> *dependencies
+) {
+    auto ctx = preprocess_context{defines, {}, {}};
+    expand(path, &source, ctx, true);
+
+    if (dependencies != nullptr) {
+        dependencies->insert(dependencies->end(), ctx.files.begin(), ctx.files.end());
+    }
+
+    return ctx.out;
+}
@@ -0,0 +1,211 @@
+#include <shader_watcher.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+ShaderWatcher::ShaderWatcher() {
+#ifdef __linux__
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (inotify_fd < 0) {
+        std::cerr << "ERROR::SHADER_WATCHER::INOTIFY_INIT_FAILED\n";
+        return;
+    }
+
+    running = true;
+    worker = std::thread([this] { run(); });
+#endif
+}
+
+ShaderWatcher::~ShaderWatcher() {
+    running = false;
+
+    if (worker.joinable()) {
+        worker.join();
+    }
+
+#ifdef __linux__
+    if (inotify_fd >= 0) {
+        close(inotify_fd);
+    }
+#endif
+}
+
+void ShaderWatcher::watch(Shader& shader) {
+#ifdef __linux__
+    if (inotify_fd < 0) {
+        return;
+    }
+
+    auto files = shader.read_sources().dependencies;
+    auto const lock = std::lock_guard{mutex};
+
+    watch_directories(files);
+    shaders.push_back(&shader);
+    dependencies.push_back(std::move(files));
+#else
+    (void)shader;
+#endif
+}
+
+void ShaderWatcher::watch_directories(std::vector<fs::path> const& files) {
+#ifdef __linux__
+    // watch directories rather than files, editors commonly save by writing
+    // a new file and renaming it over the old one
+    for (auto const& file : files) {
+        auto const dir = file.parent_path();
+        auto known = false;
+
+        for (auto const& watched : watch_dirs) {
+            known = known || watched == dir;
+        }
+
+        if (known) {
+            continue;
+        }
+
+        int const wd = inotify_add_watch(inotify_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+        if (wd < 0) {
+            std::cerr << "ERROR::SHADER_WATCHER::WATCH_FAILED\n" << dir << "\n";
+            continue;
+        }
+
+        watch_fds.push_back(wd);
+        watch_dirs.push_back(dir);
+    }
+#else
+    (void)files;
+#endif
+}
+
+std::size_t ShaderWatcher::apply() {
+    auto reloads = std::vector<pending_reload>{};
+
+    {
+        auto const lock = std::lock_guard{mutex};
+        reloads.swap(pending);
+    }
+
+    std::size_t replaced = 0;
+
+    for (auto const& reload : reloads) {
+        if (reload.shader->reload(reload.sources.vertex, reload.sources.fragment)) {
+            std::cout << "Reloaded " << reload.shader->vertex_path().string() << " + "
+                      << reload.shader->fragment_path().string() << "\n";
+            ++replaced;
+        } else {
+            std::cerr << "Keeping previous program for "
+                      << reload.shader->vertex_path().string() << " + "
+                      << reload.shader->fragment_path().string() << "\n";
+        }
+    }
+
+    return replaced;
+}
+
+void ShaderWatcher::run() {
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+
+    while (running) {
+        auto fd = pollfd{inotify_fd, POLLIN, 0};
+
+        // wake up periodically to notice `running` being cleared
+        if (poll(&fd, 1, 100) <= 0) {
+            continue;
+        }
+
+        auto const length = read(inotify_fd, buffer, sizeof(buffer));
+
+        if (length <= 0) {
+            continue;
+        }
+
+        for (auto offset = ssize_t{0}; offset < length;) {
+            auto const *event = reinterpret_cast<inotify_event const *>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            if (event->len == 0) {
+                continue;
+            }
+
+            auto dir = fs::path{};
+
+            {
+                auto const lock = std::lock_guard{mutex};
+
+                for (std::size_t i = 0; i < watch_fds.size(); ++i) {
+                    if (watch_fds[i] == event->wd) {
+                        dir = watch_dirs[i];
+                    }
+                }
+            }
+
+            if (!dir.empty()) {
+                changed(dir / event->name);
+            }
+        }
+    }
+#endif
+}
+
+void ShaderWatcher::changed(fs::path const& path) {
+    auto affected = std::vector<Shader *>{};
+
+    {
+        auto const lock = std::lock_guard{mutex};
+
+        for (std::size_t i = 0; i < shaders.size(); ++i) {
+            for (auto const& file : dependencies[i]) {
+                if (file == path) {
+                    affected.push_back(shaders[i]);
+                    break;
+                }
+            }
+        }
+    }
+
+    for (auto *shader : affected) {
+        auto reload = pending_reload{shader, shader->read_sources()};
+
+        auto const lock = std::lock_guard{mutex};
+
+        // includes may have been added or removed
+        for (std::size_t i = 0; i < shaders.size(); ++i) {
+            if (shaders[i] == shader) {
+                dependencies[i] = reload.sources.dependencies;
+            }
+        }
+
+        watch_directories(reload.sources.dependencies);
+
+        // only the latest sources matter if a file is saved several times
+        // between two frames
+        auto queued = false;
+
+        for (auto& entry : pending) {
+            if (entry.shader == shader) {
+                entry = std::move(reload);
+                queued = true;
+                break;
+            }
+        }
+
+        if (!queued) {
+            pending.push_back(std::move(reload));
+        }
+    }
+}
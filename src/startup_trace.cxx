@@ -0,0 +1,62 @@
+#include <startup_trace.h>
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace startup_trace {
+
+namespace {
+
+std::atomic<bool> trace_enabled = false;
+std::mutex trace_mutex;
+std::vector<std::string> span_names;
+std::vector<double> span_times;
+
+} // namespace
+
+void set_enabled(bool enabled) {
+    trace_enabled = enabled;
+}
+
+bool enabled() {
+    return trace_enabled;
+}
+
+void record(std::string name, double milliseconds) {
+    if (!trace_enabled) {
+        return;
+    }
+
+    auto const lock = std::lock_guard{trace_mutex};
+    span_names.push_back(std::move(name));
+    span_times.push_back(milliseconds);
+}
+
+void report(std::ostream& out) {
+    auto const lock = std::lock_guard{trace_mutex};
+
+    for (std::size_t i = 0; i < span_names.size(); ++i) {
+        out << std::fixed << std::setprecision(3) << std::setw(10) << span_times[i]
+            << " ms  " << span_names[i] << "\n";
+    }
+}
+
+scope::scope(std::string name)
+    : name(std::move(name)), start(std::chrono::steady_clock::now()) {}
+
+scope::~scope() {
+    if (!trace_enabled) {
+        return;
+    }
+
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+    record(std::move(name), std::chrono::duration<double, std::milli>(elapsed).count());
+}
+
+} // namespace startup_trace
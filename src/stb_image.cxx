@@ -0,0 +1,3 @@
+// single translation unit holding the stb_image implementation
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
@@ -0,0 +1,390 @@
+#include <texture.h>
+
+#include <gl_ext.h>
+
+#include <utility>
+
+namespace {
+
+// client format accepted when allocating `internal_format` without data
+unsigned int base_format(unsigned int internal_format) {
+    switch (internal_format) {
+        case GL_R8:
+            return GL_RED;
+        case GL_RG8:
+            return GL_RG;
+        case GL_RGB8:
+        case GL_SRGB8:
+            return GL_RGB;
+        case GL_RGBA8UI:
+            return GL_RGBA_INTEGER;
+        default:
+            return GL_RGBA;
+    }
+}
+
+// bytes per texel of an uncompressed `internal_format`
+std::size_t texel_size(unsigned int internal_format) {
+    switch (internal_format) {
+        case GL_R8:
+            return 1;
+        case GL_RG8:
+            return 2;
+        case GL_RGB8:
+        case GL_SRGB8:
+            return 3;
+        default:
+            return 4;
+    }
+}
+
+} // namespace
+
+int compressed_block_size(unsigned int internal_format) {
+    switch (internal_format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_SRGB8_ETC2:
+            return 8;
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+std::size_t compressed_level_size(unsigned int internal_format, int width, int height) {
+    auto const blocks_x = static_cast<std::size_t>((width + 3) / 4);
+    auto const blocks_y = static_cast<std::size_t>((height + 3) / 4);
+    return blocks_x * blocks_y * compressed_block_size(internal_format);
+}
+
+bool texture_format_supported(unsigned int internal_format) {
+    switch (internal_format) {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+            return GLEXT_EXT_texture_compression_s3tc != 0;
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+            return GLEXT_EXT_texture_sRGB_s3tc != 0;
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+            return GLEXT_ARB_texture_compression_bptc != 0;
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_SRGB8_ETC2:
+            return GLEXT_ARB_ES3_compatibility != 0;
+        default:
+            return true;
+    }
+}
+
+Texture2D::Texture2D(int width, int height, unsigned int internal_format, int levels)
+    : base_width(width), base_height(height),
+      level_count(levels > 0 ? levels : mip_level_count(width, height)),
+      storage_format(internal_format) {
+    glGenTextures(1, &ID);
+    glBindTexture(GL_TEXTURE_2D, ID);
+
+    if (immutable_supported()) {
+        glTexStorage2D(GL_TEXTURE_2D, level_count, storage_format, width, height);
+        return;
+    }
+
+    auto const compressed = compressed_block_size(storage_format) != 0;
+
+    for (int level = 0; level < level_count; ++level) {
+        auto const level_width = mip_level_size(width, level);
+        auto const level_height = mip_level_size(height, level);
+
+        if (compressed) {
+            glCompressedTexImage2D(
+                GL_TEXTURE_2D,
+                level,
+                storage_format,
+                level_width,
+                level_height,
+                0,
+                static_cast<GLsizei>(
+                    compressed_level_size(storage_format, level_width, level_height)
+                ),
+                NULL
+            );
+            continue;
+        }
+
+        glTexImage2D(
+            GL_TEXTURE_2D,
+            level,
+            storage_format,
+            level_width,
+            level_height,
+            0,
+            base_format(storage_format),
+            GL_UNSIGNED_BYTE,
+            NULL
+        );
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level_count - 1);
+}
+
+Texture2D::~Texture2D() {
+    glDeleteTextures(1, &ID);
+}
+
+Texture2D::Texture2D(Texture2D&& other) noexcept
+    : ID(std::exchange(other.ID, 0)), base_width(other.base_width),
+      base_height(other.base_height), level_count(other.level_count),
+      storage_format(other.storage_format) {}
+
+Texture2D& Texture2D::operator=(Texture2D&& other) noexcept {
+    if (this != &other) {
+        glDeleteTextures(1, &ID);
+
+        ID = std::exchange(other.ID, 0);
+        base_width = other.base_width;
+        base_height = other.base_height;
+        level_count = other.level_count;
+        storage_format = other.storage_format;
+    }
+
+    return *this;
+}
+
+std::size_t Texture2D::storage_size() const {
+    auto size = std::size_t{0};
+    auto const compressed = compressed_block_size(storage_format) != 0;
+
+    for (int level = 0; level < level_count; ++level) {
+        auto const width = mip_level_size(base_width, level);
+        auto const height = mip_level_size(base_height, level);
+
+        size += compressed ? compressed_level_size(storage_format, width, height)
+                           : static_cast<std::size_t>(width) * height
+                                 * texel_size(storage_format);
+    }
+
+    return size;
+}
+
+bool Texture2D::immutable_supported() {
+    return GLEXT_ARB_texture_storage != 0;
+}
+
+void Texture2D::upload(
+    int level,
+    unsigned int pixel_format,
+    unsigned int type,
+    void const *pixels
+) {
+    upload(
+        level,
+        0,
+        0,
+        mip_level_size(base_width, level),
+        mip_level_size(base_height, level),
+        pixel_format,
+        type,
+        pixels
+    );
+}
+
+void Texture2D::upload(
+    int level,
+    int x,
+    int y,
+    int width,
+    int height,
+    unsigned int pixel_format,
+    unsigned int type,
+    void const *pixels
+) {
+    glBindTexture(GL_TEXTURE_2D, ID);
+    glTexSubImage2D(
+        GL_TEXTURE_2D,
+        level,
+        x,
+        y,
+        width,
+        height,
+        pixel_format,
+        type,
+        pixels
+    );
+}
+
+void Texture2D::upload_compressed(int level, std::size_t size, void const *data) {
+    glBindTexture(GL_TEXTURE_2D, ID);
+    glCompressedTexSubImage2D(
+        GL_TEXTURE_2D,
+        level,
+        0,
+        0,
+        mip_level_size(base_width, level),
+        mip_level_size(base_height, level),
+        storage_format,
+        static_cast<GLsizei>(size),
+        data
+    );
+}
+
+void Texture2D::upload_compressed(
+    int level,
+    int x,
+    int y,
+    int width,
+    int height,
+    std::size_t size,
+    void const *data
+) {
+    glBindTexture(GL_TEXTURE_2D, ID);
+    glCompressedTexSubImage2D(
+        GL_TEXTURE_2D,
+        level,
+        x,
+        y,
+        width,
+        height,
+        storage_format,
+        static_cast<GLsizei>(size),
+        data
+    );
+}
+
+void Texture2D::generate_mipmaps() {
+    if (level_count > 1) {
+        glBindTexture(GL_TEXTURE_2D, ID);
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+}
+
+void Texture2D::set_sampler(texture_sampler const& sampler) {
+    glBindTexture(GL_TEXTURE_2D, ID);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, sampler.wrap_s);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, sampler.wrap_t);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, sampler.min_filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, sampler.mag_filter);
+}
+
+void Texture2D::bind(int unit) const {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, ID);
+}
+
+Texture2DArray::Texture2DArray(
+    int width,
+    int height,
+    int layers,
+    unsigned int internal_format,
+    int levels
+)
+    : base_width(width), base_height(height), layer_count(layers),
+      level_count(levels > 0 ? levels : mip_level_count(width, height)),
+      storage_format(internal_format) {
+    glGenTextures(1, &ID);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+
+    if (immutable_supported()) {
+        glTexStorage3D(
+            GL_TEXTURE_2D_ARRAY,
+            level_count,
+            storage_format,
+            width,
+            height,
+            layers
+        );
+        return;
+    }
+
+    for (int level = 0; level < level_count; ++level) {
+        glTexImage3D(
+            GL_TEXTURE_2D_ARRAY,
+            level,
+            storage_format,
+            mip_level_size(width, level),
+            mip_level_size(height, level),
+            layers,
+            0,
+            base_format(storage_format),
+            GL_UNSIGNED_BYTE,
+            NULL
+        );
+    }
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, level_count - 1);
+}
+
+Texture2DArray::~Texture2DArray() {
+    glDeleteTextures(1, &ID);
+}
+
+Texture2DArray::Texture2DArray(Texture2DArray&& other) noexcept
+    : ID(std::exchange(other.ID, 0)), base_width(other.base_width),
+      base_height(other.base_height), layer_count(other.layer_count),
+      level_count(other.level_count), storage_format(other.storage_format) {}
+
+Texture2DArray& Texture2DArray::operator=(Texture2DArray&& other) noexcept {
+    if (this != &other) {
+        glDeleteTextures(1, &ID);
+
+        ID = std::exchange(other.ID, 0);
+        base_width = other.base_width;
+        base_height = other.base_height;
+        layer_count = other.layer_count;
+        level_count = other.level_count;
+        storage_format = other.storage_format;
+    }
+
+    return *this;
+}
+
+bool Texture2DArray::immutable_supported() {
+    return GLEXT_ARB_texture_storage != 0;
+}
+
+void Texture2DArray::upload(
+    int layer,
+    int level,
+    unsigned int pixel_format,
+    unsigned int type,
+    void const *pixels
+) {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+    glTexSubImage3D(
+        GL_TEXTURE_2D_ARRAY,
+        level,
+        0,
+        0,
+        layer,
+        mip_level_size(base_width, level),
+        mip_level_size(base_height, level),
+        1,
+        pixel_format,
+        type,
+        pixels
+    );
+}
+
+void Texture2DArray::generate_mipmaps() {
+    if (level_count > 1) {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    }
+}
+
+void Texture2DArray::set_sampler(texture_sampler const& sampler) {
+    glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, sampler.wrap_s);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, sampler.wrap_t);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, sampler.min_filter);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, sampler.mag_filter);
+}
+
+void Texture2DArray::bind(int unit) const {
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, ID);
+}
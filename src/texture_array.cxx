@@ -0,0 +1,216 @@
+#include <texture_array.h>
+
+#include <glad/glad.h>
+
+#include "stb_image.h"
+
+#include <mapped_file.h>
+#include <mipmap.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// stb_image takes the encoded length as an int
+constexpr auto max_file_size = static_cast<std::size_t>(std::numeric_limits<int>::max());
+
+// decoded RGBA levels of one image, empty if decoding failed
+struct decoded_layer {
+    std::vector<unsigned char> pixels;
+    std::vector<mip_level> mips;
+};
+
+} // namespace
+
+TextureArrayBuilder::TextureArrayBuilder(bool srgb) : srgb(srgb) {
+    // GL 3.3 guarantees at least 256
+    max_layers = 256;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &max_layers);
+    max_layers = std::max(max_layers, 1);
+}
+
+texture_layer TextureArrayBuilder::add(std::string path, image_options options) {
+    auto const file = mapping_cache::open(path, file_access::sequential);
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+
+    if (!file->ok() || file->size() > max_file_size
+        || !stbi_info_from_memory(
+            file->data(),
+            static_cast<int>(file->size()),
+            &width,
+            &height,
+            &channels
+        )) {
+        std::cerr << "ERROR::TEXTURE_ARRAY::FILE_NOT_SUCCESSFULLY_READ\n" << path << "\n";
+        return texture_layer{};
+    }
+
+    auto layer = texture_layer{};
+
+    for (std::size_t i = 0; i < widths.size(); ++i) {
+        if (widths[i] == width && heights[i] == height && layer_counts[i] < max_layers) {
+            layer = texture_layer{static_cast<int>(i), layer_counts[i]++};
+            break;
+        }
+    }
+
+    if (layer.array < 0) {
+        widths.push_back(width);
+        heights.push_back(height);
+        layer_counts.push_back(1);
+        layer = texture_layer{static_cast<int>(widths.size()) - 1, 0};
+    }
+
+    images.push_back(queued_image{std::move(path), options, layer});
+    return layer;
+}
+
+std::vector<Texture2DArray> TextureArrayBuilder::build(unsigned int threads) const {
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    auto arrays = std::vector<Texture2DArray>{};
+    auto const format = srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+
+    int alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (std::size_t a = 0; a < widths.size(); ++a) {
+        // images of this array, decoded and uploaded before the next one
+        auto members = std::vector<queued_image const *>{};
+
+        for (auto const& image : images) {
+            if (image.layer.array == static_cast<int>(a)) {
+                members.push_back(&image);
+            }
+        }
+
+        auto decoded = std::vector<decoded_layer>(members.size());
+        auto next = std::atomic<std::size_t>{0};
+
+        auto const decode = [&] {
+            for (auto i = next++; i < members.size(); i = next++) {
+                auto const& image = *members[i];
+                auto const file =
+                    mapping_cache::open(image.path, file_access::sequential);
+                int width = 0;
+                int height = 0;
+                int channels = 0;
+
+                unsigned char *pixels = NULL;
+
+                // RGB is widened by `expand_rgb_to_rgba` while it is copied
+                // out, the decoder converts the rarer grey formats itself
+                if (file->ok() && file->size() <= max_file_size
+                    && stbi_info_from_memory(
+                        file->data(),
+                        static_cast<int>(file->size()),
+                        &width,
+                        &height,
+                        &channels
+                    )) {
+                    pixels = stbi_load_from_memory(
+                        file->data(),
+                        static_cast<int>(file->size()),
+                        &width,
+                        &height,
+                        &channels,
+                        channels == 3 ? 3 : 4
+                    );
+                }
+
+                // the file may have changed since `add` read its header
+                if (pixels == NULL || width != widths[a] || height != heights[a]) {
+                    stbi_image_free(pixels);
+                    continue;
+                }
+
+                auto const count = static_cast<std::size_t>(width) * height;
+                auto& texels = decoded[i].pixels;
+
+                if (channels == 3) {
+                    texels.resize(count * 4);
+                    expand_rgb_to_rgba(pixels, texels.data(), count);
+                } else {
+                    texels.assign(pixels, pixels + count * 4);
+                }
+
+                stbi_image_free(pixels);
+                transform_image(texels.data(), width, height, 4, image.options);
+
+                decoded[i].mips = build_mip_chain(
+                    texels.data(),
+                    width,
+                    height,
+                    4,
+                    mip_options{mip_filter::box, srgb, 1}
+                );
+            }
+        };
+
+        auto workers = std::vector<std::thread>{};
+        auto const count = std::min<std::size_t>(threads, members.size());
+
+        for (std::size_t i = 1; i < count; ++i) {
+            workers.emplace_back(decode);
+        }
+
+        decode();
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+
+        auto& array = arrays.emplace_back(widths[a], heights[a], layer_counts[a], format);
+
+        for (std::size_t i = 0; i < members.size(); ++i) {
+            auto const layer = members[i]->layer.layer;
+
+            if (decoded[i].pixels.empty()) {
+                std::cerr << "ERROR::TEXTURE_ARRAY::DECODE_FAILED\n"
+                          << members[i]->path << "\n";
+
+                auto const white = std::vector<unsigned char>(
+                    static_cast<std::size_t>(array.width()) * array.height() * 4,
+                    255
+                );
+
+                for (int level = 0; level < array.levels(); ++level) {
+                    array.upload(layer, level, GL_RGBA, GL_UNSIGNED_BYTE, white.data());
+                }
+
+                continue;
+            }
+
+            auto const& levels = decoded[i];
+            array.upload(layer, 0, GL_RGBA, GL_UNSIGNED_BYTE, levels.pixels.data());
+
+            for (std::size_t level = 0; level < levels.mips.size(); ++level) {
+                array.upload(
+                    layer,
+                    static_cast<int>(level) + 1,
+                    GL_RGBA,
+                    GL_UNSIGNED_BYTE,
+                    levels.mips[level].pixels.data()
+                );
+            }
+        }
+
+        array.set_sampler(texture_sampler{});
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    return arrays;
+}
@@ -0,0 +1,216 @@
+#include <texture_cache.h>
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+TextureCache::TextureCache(
+    std::size_t vram_budget,
+    unsigned int threads,
+    mip_generation mips
+)
+    : loader(threads, mips), vram_budget(vram_budget) {}
+
+TextureCache::~TextureCache() {
+    if (!sampler_ids.empty()) {
+        glDeleteSamplers(static_cast<GLsizei>(sampler_ids.size()), sampler_ids.data());
+    }
+}
+
+cached_texture TextureCache::acquire(
+    std::string const& path,
+    texture_sampler const& sampler,
+    image_options const& options
+) {
+    auto const index = sampler_index(sampler);
+    auto source = texture_handle{};
+    auto& variants = path_entries[path];
+
+    for (auto const i : variants) {
+        auto& current = entries[i];
+
+        if (current.options != options) {
+            continue;
+        }
+
+        if (current.sampler == index) {
+            if (current.source.index < 0) {
+                current.source = loader.load(path, options);
+                ++counters.loads;
+            } else {
+                ++counters.hits;
+            }
+
+            ++current.refs;
+            touch(current);
+            return cached_texture{i};
+        }
+
+        // the same file with another sampler shares the texture
+        if (current.source.index >= 0) {
+            source = current.source;
+        }
+    }
+
+    if (source.index < 0) {
+        source = loader.load(path, options);
+        ++counters.loads;
+    } else {
+        ++counters.hits;
+    }
+
+    variants.push_back(static_cast<int>(entries.size()));
+    entries.push_back(entry{path, options, index, source, 1});
+    touch(entries.back());
+    return cached_texture{variants.back()};
+}
+
+void TextureCache::release(cached_texture texture) {
+    if (texture.index >= 0 && entries[texture.index].refs > 0) {
+        --entries[texture.index].refs;
+    }
+}
+
+std::size_t TextureCache::update(std::size_t byte_budget) {
+    auto const remaining = loader.update(byte_budget);
+
+    ++frame;
+    evict();
+    return remaining;
+}
+
+void TextureCache::bind(cached_texture texture, int unit) {
+    auto const& current = entries[texture.index];
+
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D, loader.texture(current.source));
+    glBindSampler(static_cast<unsigned int>(unit), sampler_ids[current.sampler]);
+    touch(current);
+}
+
+unsigned int TextureCache::texture(cached_texture texture) const {
+    return loader.texture(entries[texture.index].source);
+}
+
+unsigned int TextureCache::sampler(cached_texture texture) const {
+    return sampler_ids[entries[texture.index].sampler];
+}
+
+bool TextureCache::ready(cached_texture texture) const {
+    return loader.ready(entries[texture.index].source);
+}
+
+std::size_t TextureCache::resident_size() const {
+    // entries sharing a texture share its loader handle, so it counts once
+    return loader.resident_size();
+}
+
+int TextureCache::sampler_index(texture_sampler const& sampler) {
+    for (std::size_t i = 0; i < sampler_params.size(); ++i) {
+        if (sampler_params[i] == sampler) {
+            return static_cast<int>(i);
+        }
+    }
+
+    unsigned int id = 0;
+    glGenSamplers(1, &id);
+    glSamplerParameteri(id, GL_TEXTURE_WRAP_S, sampler.wrap_s);
+    glSamplerParameteri(id, GL_TEXTURE_WRAP_T, sampler.wrap_t);
+    glSamplerParameteri(id, GL_TEXTURE_MIN_FILTER, sampler.min_filter);
+    glSamplerParameteri(id, GL_TEXTURE_MAG_FILTER, sampler.mag_filter);
+
+    sampler_params.push_back(sampler);
+    sampler_ids.push_back(id);
+    return static_cast<int>(sampler_ids.size()) - 1;
+}
+
+void TextureCache::touch(entry const& current) {
+    auto const owner = loader.owner(current.source);
+
+    if (owner.index < 0) {
+        return;
+    }
+
+    if (static_cast<std::size_t>(owner.index) >= last_used.size()) {
+        last_used.resize(owner.index + 1, 0);
+    }
+
+    last_used[owner.index] = frame;
+}
+
+void TextureCache::evict() {
+    if (loader.resident_size() <= vram_budget) {
+        return;
+    }
+
+    owner_refs.assign(last_used.size(), 0);
+
+    for (auto const& current : entries) {
+        auto const owner = loader.owner(current.source);
+
+        if (owner.index < 0) {
+            continue;
+        }
+
+        if (static_cast<std::size_t>(owner.index) >= owner_refs.size()) {
+            owner_refs.resize(owner.index + 1, 0);
+        }
+
+        owner_refs[owner.index] += current.refs;
+    }
+
+    // unreferenced resident textures, least recently used first
+    auto victims = std::vector<texture_handle>{};
+    auto listed = std::vector<bool>(owner_refs.size(), false);
+
+    for (auto const& current : entries) {
+        auto const owner = loader.owner(current.source);
+
+        if (!loader.ready(owner) || listed[owner.index] || owner_refs[owner.index] > 0) {
+            continue;
+        }
+
+        listed[owner.index] = true;
+        victims.push_back(owner);
+    }
+
+    auto const used = [&](texture_handle owner) {
+        return static_cast<std::size_t>(owner.index) < last_used.size()
+                 ? last_used[owner.index]
+                 : 0;
+    };
+
+    std::sort(victims.begin(), victims.end(), [&](texture_handle a, texture_handle b) {
+        return used(a) < used(b);
+    });
+
+    auto evicted = std::vector<bool>(owner_refs.size(), false);
+
+    // anything left over is in use, the budget is exceeded until released
+    for (auto const victim : victims) {
+        if (loader.resident_size() <= vram_budget) {
+            break;
+        }
+
+        // skipped while a load in flight turned out to share the texture
+        if (!loader.unload(victim)) {
+            continue;
+        }
+
+        evicted[victim.index] = true;
+        ++counters.evictions;
+    }
+
+    for (auto& current : entries) {
+        auto const owner = loader.owner(current.source);
+
+        if (owner.index >= 0 && evicted[owner.index]) {
+            current.source = texture_handle{};
+        }
+    }
+}
@@ -0,0 +1,237 @@
+#include <texture_container.h>
+
+#include <file_loader.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <system_error>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// bumped whenever the layout changes
+constexpr std::uint32_t container_version = 1;
+constexpr char container_magic[8] = {'L', 'O', 'G', 'L', 'T', 'E', 'X', '\n'};
+constexpr std::uint64_t level_alignment = 16;
+
+static_assert(sizeof(container_header) == 48);
+static_assert(sizeof(container_level_index) == 16);
+
+std::uint64_t align_up(std::uint64_t offset) {
+    return (offset + level_alignment - 1) / level_alignment * level_alignment;
+}
+
+// bytes `level` of `header` takes, 0 if the format isn't one the loaders
+// read: block-compressed or 8-bit texels of one to four channels
+std::uint64_t expected_level_size(container_header const& header, int level) {
+    auto const width = mip_level_size(static_cast<int>(header.width), level);
+    auto const height = mip_level_size(static_cast<int>(header.height), level);
+
+    if (header.flags & CONTAINER_COMPRESSED) {
+        if (compressed_block_size(header.internal_format) == 0) {
+            return 0;
+        }
+
+        return compressed_level_size(header.internal_format, width, height);
+    }
+
+    if (header.type != GL_UNSIGNED_BYTE) {
+        return 0;
+    }
+
+    auto channels = std::uint64_t{0};
+
+    switch (header.pixel_format) {
+        case GL_RED:
+            channels = 1;
+            break;
+        case GL_RG:
+            channels = 2;
+            break;
+        case GL_RGB:
+            channels = 3;
+            break;
+        case GL_RGBA:
+            channels = 4;
+            break;
+    }
+
+    return std::uint64_t{static_cast<unsigned int>(width)} * height * channels;
+}
+
+} // namespace
+
+bool write_texture_container(
+    fs::path const& path,
+    container_header header,
+    std::vector<std::vector<unsigned char>> const& levels
+) {
+    std::memcpy(header.magic, container_magic, sizeof(header.magic));
+    header.version = container_version;
+    header.level_count = static_cast<std::uint32_t>(levels.size());
+
+    auto index = std::vector<container_level_index>{};
+    auto offset = std::uint64_t{sizeof(container_header)}
+                + levels.size() * sizeof(container_level_index);
+
+    for (auto const& level : levels) {
+        offset = align_up(offset);
+        index.push_back(container_level_index{offset, level.size()});
+        offset += level.size();
+    }
+
+    // write next to the destination and rename so readers never see a
+    // partial file
+    auto const tmp = temporary_path(path);
+    auto error = std::error_code{};
+
+    {
+        auto out = std::ofstream(tmp, std::ios::binary);
+        out.write(reinterpret_cast<char const *>(&header), sizeof(header));
+        out.write(
+            reinterpret_cast<char const *>(index.data()),
+            static_cast<std::streamsize>(index.size() * sizeof(container_level_index))
+        );
+
+        for (std::size_t i = 0; i < levels.size(); ++i) {
+            auto const written = static_cast<std::uint64_t>(out.tellp());
+            auto const padding = index[i].offset - written;
+            char const zeros[level_alignment] = {0};
+
+            out.write(zeros, static_cast<std::streamsize>(padding));
+            out.write(
+                reinterpret_cast<char const *>(levels[i].data()),
+                static_cast<std::streamsize>(levels[i].size())
+            );
+        }
+
+        if (!out) {
+            std::cerr << "ERROR::TEXTURE_CONTAINER::WRITE_FAILED\n"
+                      << tmp.string() << "\n";
+            out.close();
+            fs::remove(tmp, error);
+            return false;
+        }
+    }
+
+    fs::rename(tmp, path, error);
+
+    if (error) {
+        std::cerr << "ERROR::TEXTURE_CONTAINER::RENAME_FAILED\n"
+                  << path.string() << "\n" << error.message() << "\n";
+        fs::remove(tmp, error);
+        return false;
+    }
+
+    return true;
+}
+
+TextureContainer::TextureContainer(fs::path const& path, file_access access)
+    : file(mapping_cache::open(path, access)) {
+    auto const size = file->size();
+
+    if (!file->ok() || size < sizeof(container_header)) {
+        std::cerr << "ERROR::TEXTURE_CONTAINER::FILE_NOT_SUCCESSFULLY_READ\n"
+                  << path.string() << "\n";
+        return;
+    }
+
+    // the mapping may be shared with a reader that opened it sequentially;
+    // a random reader wins, sequential ones only lose read-ahead
+    if (access != file_access::sequential) {
+        file->advise(access);
+    }
+
+    std::memcpy(&info, file->data(), sizeof(info));
+
+    auto const index_size =
+        std::uint64_t{info.level_count} * sizeof(container_level_index);
+    auto const index_end = sizeof(container_header) + index_size;
+
+    auto const max_size = static_cast<std::uint32_t>(std::numeric_limits<int>::max());
+    auto const dimensions_ok = info.width > 0 && info.height > 0
+                            && info.width <= max_size && info.height <= max_size;
+
+    if (std::memcmp(info.magic, container_magic, sizeof(info.magic)) != 0
+        || info.version != container_version || !dimensions_ok
+        || info.level_count == 0
+        || info.level_count > static_cast<std::uint32_t>(mip_level_count(
+               static_cast<int>(info.width),
+               static_cast<int>(info.height)
+           ))
+        || index_end > size) {
+        std::cerr << "ERROR::TEXTURE_CONTAINER::INVALID_HEADER\n"
+                  << path.string() << "\n";
+        return;
+    }
+
+    for (int level = 0; level < levels(); ++level) {
+        auto const entry = level_entry(level);
+
+        if (entry.offset > size || entry.size > size - entry.offset) {
+            std::cerr << "ERROR::TEXTURE_CONTAINER::TRUNCATED\n" << path.string() << "\n";
+            return;
+        }
+
+        // readers index the level by the header's dimensions, compressed
+        // levels are uploaded whole so they must match exactly
+        auto const expected = expected_level_size(info, level);
+        auto const compressed = (info.flags & CONTAINER_COMPRESSED) != 0;
+
+        if (expected == 0 || entry.size < expected
+            || (compressed && entry.size != expected)) {
+            std::cerr << "ERROR::TEXTURE_CONTAINER::INVALID_LEVEL\n"
+                      << path.string() << " level " << level << "\n";
+            return;
+        }
+    }
+
+    valid = true;
+}
+
+container_level_index TextureContainer::level_entry(int level) const {
+    auto entry = container_level_index{};
+    auto const offset = sizeof(container_header) + level * sizeof(container_level_index);
+
+    std::memcpy(&entry, file->data() + offset, sizeof(entry));
+    return entry;
+}
+
+unsigned char const *TextureContainer::level_data(int level) const {
+    return file->data() + level_entry(level).offset;
+}
+
+std::size_t TextureContainer::level_size(int level) const {
+    return static_cast<std::size_t>(level_entry(level).size);
+}
+
+Texture2D TextureContainer::upload() const {
+    auto texture = Texture2D(
+        static_cast<int>(info.width),
+        static_cast<int>(info.height),
+        info.internal_format,
+        levels()
+    );
+
+    int alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (int level = 0; level < levels(); ++level) {
+        if (info.flags & CONTAINER_COMPRESSED) {
+            texture.upload_compressed(level, level_size(level), level_data(level));
+        } else {
+            texture.upload(level, info.pixel_format, info.type, level_data(level));
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+    return texture;
+}
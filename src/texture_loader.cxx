@@ -0,0 +1,552 @@
+#include <texture_loader.h>
+
+#include <glad/glad.h>
+
+#include "stb_image.h"
+
+#include <mapped_file.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace {
+
+// staging memory shared by every image in flight
+constexpr std::size_t upload_ring_size = 32 * 1024 * 1024;
+
+constexpr std::uint64_t fnv1a64_basis = 14695981039346656037ull;
+
+// 64-bit FNV-1a over `size` bytes, continuing from `hash`
+std::uint64_t fnv1a64(void const *data, std::size_t size, std::uint64_t hash) {
+    auto const *bytes = static_cast<unsigned char const *>(data);
+
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+unsigned int pixel_format(int channels) {
+    switch (channels) {
+        case 1:
+            return GL_RED;
+        case 2:
+            return GL_RG;
+        case 3:
+            return GL_RGB;
+        default:
+            return GL_RGBA;
+    }
+}
+
+int format_channels(unsigned int pixel_format) {
+    switch (pixel_format) {
+        case GL_RED:
+            return 1;
+        case GL_RG:
+            return 2;
+        case GL_RGB:
+            return 3;
+        default:
+            return 4;
+    }
+}
+
+int internal_format(int channels) {
+    switch (channels) {
+        case 1:
+            return GL_R8;
+        case 2:
+            return GL_RG8;
+        case 3:
+            return GL_RGB8;
+        default:
+            return GL_RGBA8;
+    }
+}
+
+} // namespace
+
+TextureLoader::TextureLoader(unsigned int threads, mip_generation mips)
+    : placeholder(1, 1, GL_RGBA8, 1), mip_mode(mips) {
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+
+    unsigned char const white[] = {255, 255, 255, 255};
+
+    placeholder.upload(0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+    placeholder.set_sampler(
+        texture_sampler{GL_REPEAT, GL_REPEAT, GL_NEAREST, GL_NEAREST}
+    );
+
+    if (UploadRing::supported()) {
+        ring.emplace(upload_ring_size);
+    }
+
+    for (unsigned int i = 0; i < threads; ++i) {
+        workers.emplace_back([this] { run(); });
+    }
+}
+
+TextureLoader::~TextureLoader() {
+    {
+        auto const lock = std::lock_guard{mutex};
+        running = false;
+    }
+
+    wake.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (auto *image = decoded.exchange(nullptr); image != nullptr;) {
+        auto *next = image->next;
+        stbi_image_free(image->pixels);
+        delete image;
+        image = next;
+    }
+
+    for (auto& current : uploads) {
+        stbi_image_free(current.image->pixels);
+        delete current.image;
+    }
+}
+
+texture_handle TextureLoader::load(std::string path, image_options options) {
+    auto const index = static_cast<int>(paths.size());
+
+    paths.push_back(path);
+    textures.emplace_back();
+    owners.push_back(index);
+    ++outstanding;
+
+    {
+        auto const lock = std::lock_guard{mutex};
+        jobs.push_back(decode_job{index, std::move(path), options});
+    }
+
+    wake.notify_one();
+    return texture_handle{index};
+}
+
+void TextureLoader::run() {
+    while (true) {
+        auto job = decode_job{};
+
+        {
+            auto lock = std::unique_lock{mutex};
+            wake.wait(lock, [this] { return !running || !jobs.empty(); });
+
+            if (!running) {
+                return;
+            }
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        auto *image = new decoded_image{};
+        image->index = job.index;
+        image->alias = -1;
+
+        if (std::filesystem::path(job.path).extension() == texture_container_extension) {
+            auto& container = image->container.emplace(job.path);
+
+            if (container.ok()) {
+                auto const& header = container.header();
+                auto content = fnv1a64(&header, sizeof(header), fnv1a64_basis);
+
+                for (int level = 0; level < container.levels(); ++level) {
+                    content = fnv1a64(
+                        container.level_data(level),
+                        container.level_size(level),
+                        content
+                    );
+                }
+
+                image->content = content;
+                image->alias = claim_content(content, job.index);
+                image->width = static_cast<int>(header.width);
+                image->height = static_cast<int>(header.height);
+                image->channels = format_channels(header.pixel_format);
+            }
+
+            if (!container.ok() || image->alias >= 0) {
+                image->container.reset();
+            }
+        } else {
+            decode(job, *image);
+        }
+
+        image->next = decoded.load(std::memory_order_relaxed);
+
+        while (!decoded.compare_exchange_weak(
+            image->next,
+            image,
+            std::memory_order_release,
+            std::memory_order_relaxed
+        )) {}
+    }
+}
+
+void TextureLoader::decode(decode_job const& job, decoded_image& image) {
+    // the decoder reads straight out of the page cache, no stdio buffers or
+    // copies, and jobs for the same file share one mapping
+    auto const file = mapping_cache::open(job.path, file_access::sequential);
+
+    // stb_image takes the length as an int
+    if (!file->ok()
+        || file->size() > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        return;
+    }
+
+    // the same file with other options is a different texture
+    unsigned char const variant[] = {
+        job.options.flip,
+        job.options.expand_rgba,
+        job.options.swizzle_bgra,
+        job.options.premultiply,
+    };
+
+    image.content = fnv1a64(variant, sizeof(variant), fnv1a64_basis);
+    image.content = fnv1a64(file->data(), file->size(), image.content);
+    image.alias = claim_content(image.content, job.index);
+
+    if (image.alias >= 0) {
+        return;
+    }
+
+    image.pixels = stbi_load_from_memory(
+        file->data(),
+        static_cast<int>(file->size()),
+        &image.width,
+        &image.height,
+        &image.channels,
+        0
+    );
+
+    if (image.pixels == NULL) {
+        return;
+    }
+
+    auto const count = static_cast<std::size_t>(image.width) * image.height;
+
+    if (job.options.expand_rgba && image.channels == 3) {
+        image.expanded.resize(count * 4);
+        expand_rgb_to_rgba(image.pixels, image.expanded.data(), count);
+        stbi_image_free(image.pixels);
+        image.pixels = nullptr;
+        image.channels = 4;
+    }
+
+    auto *texels = image.pixels != nullptr ? image.pixels : image.expanded.data();
+    transform_image(texels, image.width, image.height, image.channels, job.options);
+
+    // the worker is already off the GL thread, so the levels are filtered
+    // serially here
+    if (mip_mode == mip_generation::cpu) {
+        image.mips = build_mip_chain(
+            texels,
+            image.width,
+            image.height,
+            image.channels,
+            mip_options{mip_filter::box, false, 1}
+        );
+    }
+
+    auto const bytes = count * image.channels;
+
+    // images that don't fit in the ring right now stay in client memory
+    if (ring && ring->allocate(bytes, image.region)) {
+        std::memcpy(image.region.data, texels, bytes);
+        stbi_image_free(image.pixels);
+        image.pixels = nullptr;
+        image.expanded = {};
+    }
+}
+
+std::size_t TextureLoader::update(std::size_t byte_budget) {
+    if (ring) {
+        ring->reclaim();
+    }
+
+    // the stack holds the newest image first, reverse it to upload in
+    // completion order
+    decoded_image *finished = nullptr;
+
+    for (auto *image = decoded.exchange(nullptr, std::memory_order_acquire);
+         image != nullptr;) {
+        auto *next = image->next;
+        image->next = finished;
+        finished = image;
+        image = next;
+    }
+
+    for (auto *image = finished; image != nullptr;) {
+        auto *next = image->next;
+
+        if (image->alias >= 0) {
+            {
+                auto const lock = std::lock_guard{mutex};
+
+                if (--pending_aliases[image->alias] == 0) {
+                    pending_aliases.erase(image->alias);
+                }
+            }
+
+            owners[image->index] = image->alias;
+            --outstanding;
+            delete image;
+        } else if (image->pixels == NULL && image->expanded.empty()
+                   && image->region.data == nullptr && !image->container) {
+            std::cerr << "ERROR::TEXTURE::FILE_NOT_SUCCESSFULLY_READ\n"
+                      << paths[image->index] << "\n";
+            forget_content(image->index);
+            --outstanding;
+            delete image;
+        } else if (image->container && !texture_format_supported(
+                       image->container->header().internal_format
+                   )) {
+            std::cerr << "ERROR::TEXTURE::UNSUPPORTED_FORMAT\n"
+                      << paths[image->index] << "\n";
+            forget_content(image->index);
+            --outstanding;
+            delete image;
+        } else {
+            uploads.push_back(upload{image, std::nullopt, 0, 0});
+        }
+
+        image = next;
+    }
+
+    int alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    auto spent = std::size_t{0};
+
+    while (!uploads.empty() && (spent < byte_budget || spent == 0)) {
+        auto& current = uploads.front();
+        auto const *image = current.image;
+        auto const& container = image->container;
+
+        auto const format = container ? container->header().pixel_format
+                                      : pixel_format(image->channels);
+        auto const width = mip_level_size(image->width, current.level);
+        auto const height = mip_level_size(image->height, current.level);
+
+        // a container brings its own levels, decoded images get a full chain
+        // either filtered by the worker or generated once level 0 is in
+        if (!current.texture) {
+            current.texture.emplace(
+                image->width,
+                image->height,
+                container ? container->header().internal_format
+                          : internal_format(image->channels),
+                container ? container->levels() : 0
+            );
+        }
+
+        // block-compressed levels go up whole, they are small next to the
+        // budget and can't be split along arbitrary rows
+        auto const compressed = container
+                             && (container->header().flags & CONTAINER_COMPRESSED);
+
+        if (compressed) {
+            auto const size = container->level_size(current.level);
+
+            current.texture->upload_compressed(
+                current.level,
+                size,
+                container->level_data(current.level)
+            );
+
+            spent += size;
+
+            if (++current.level == container->levels()) {
+                finish(current);
+                uploads.pop_front();
+            }
+
+            continue;
+        }
+
+        auto const row_bytes = static_cast<std::size_t>(width) * image->channels;
+        auto const budget_rows =
+            spent < byte_budget ? (byte_budget - spent) / row_bytes : 0;
+        auto const rows = std::clamp(
+            static_cast<int>(std::min<std::size_t>(budget_rows, height)),
+            1,
+            height - current.row
+        );
+
+        // with a buffer bound to GL_PIXEL_UNPACK_BUFFER the pointer is an
+        // offset into it
+        auto const row_offset = current.row * row_bytes;
+        auto const staged = image->region.data != nullptr && current.level == 0;
+        void const *texels = nullptr;
+
+        if (staged) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring->ID);
+            texels = reinterpret_cast<void const *>(image->region.offset + row_offset);
+        } else if (container) {
+            texels = container->level_data(current.level) + row_offset;
+        } else if (current.level > 0) {
+            texels = image->mips[current.level - 1].pixels.data() + row_offset;
+        } else if (image->pixels != nullptr) {
+            texels = image->pixels + row_offset;
+        } else {
+            texels = image->expanded.data() + row_offset;
+        }
+
+        current.texture->upload(
+            current.level,
+            0,
+            current.row,
+            width,
+            rows,
+            format,
+            GL_UNSIGNED_BYTE,
+            texels
+        );
+
+        if (staged) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+
+        current.row += rows;
+        spent += rows * row_bytes;
+
+        if (current.row < height) {
+            continue;
+        }
+
+        current.row = 0;
+        ++current.level;
+
+        auto const levels = container ? container->levels()
+                                      : 1 + static_cast<int>(image->mips.size());
+
+        if (current.level == levels) {
+            finish(current);
+            uploads.pop_front();
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+
+    if (ring) {
+        ring->fence();
+    }
+
+    return outstanding;
+}
+
+void TextureLoader::finish(upload& current) {
+    current.texture->set_sampler(texture_sampler{});
+
+    if (!current.image->container && current.image->mips.empty()) {
+        current.texture->generate_mipmaps();
+    }
+
+    resident_bytes += current.texture->storage_size();
+    textures[current.image->index] = std::move(current.texture);
+    --outstanding;
+
+    if (current.image->region.data != nullptr) {
+        ring->submit(current.image->region);
+    }
+
+    stbi_image_free(current.image->pixels);
+    delete current.image;
+}
+
+unsigned int TextureLoader::texture(texture_handle handle) const {
+    if (!ready(handle)) {
+        return placeholder.ID;
+    }
+
+    return textures[owners[handle.index]]->ID;
+}
+
+bool TextureLoader::ready(texture_handle handle) const {
+    return handle.index >= 0 && textures[owners[handle.index]].has_value();
+}
+
+texture_handle TextureLoader::owner(texture_handle handle) const {
+    return handle.index >= 0 ? texture_handle{owners[handle.index]} : handle;
+}
+
+std::size_t TextureLoader::resident_size(texture_handle handle) const {
+    return ready(handle) ? textures[owners[handle.index]]->storage_size() : 0;
+}
+
+bool TextureLoader::unload(texture_handle handle) {
+    if (handle.index < 0) {
+        return false;
+    }
+
+    auto const index = owners[handle.index];
+
+    {
+        // checked and forgotten under one lock so no worker can claim the
+        // content in between
+        auto const lock = std::lock_guard{mutex};
+
+        if (pending_aliases.contains(index)) {
+            return false;
+        }
+
+        erase_content(index);
+    }
+
+    if (textures[index]) {
+        resident_bytes -= textures[index]->storage_size();
+    }
+
+    textures[index].reset();
+    return true;
+}
+
+int TextureLoader::claim_content(std::uint64_t content, int index) {
+    auto const lock = std::lock_guard{mutex};
+
+    for (std::size_t i = 0; i < contents.size(); ++i) {
+        if (contents[i] == content) {
+            ++pending_aliases[content_owners[i]];
+            return content_owners[i];
+        }
+    }
+
+    contents.push_back(content);
+    content_owners.push_back(index);
+    return -1;
+}
+
+void TextureLoader::forget_content(int index) {
+    auto const lock = std::lock_guard{mutex};
+    erase_content(index);
+}
+
+void TextureLoader::erase_content(int index) {
+    for (std::size_t i = 0; i < content_owners.size(); ++i) {
+        if (content_owners[i] == index) {
+            contents.erase(contents.begin() + i);
+            content_owners.erase(content_owners.begin() + i);
+            return;
+        }
+    }
+}
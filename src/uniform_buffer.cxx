@@ -0,0 +1,48 @@
+#include <uniform_buffer.h>
+
+#include <cstddef>
+#include <utility>
+
+UniformBuffer::UniformBuffer(std::size_t size, unsigned int binding)
+    : ID(0), buffer_size(size), binding_point(binding) {
+    glGenBuffers(1, &ID);
+    glBindBuffer(GL_UNIFORM_BUFFER, ID);
+    glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(size), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    bind();
+}
+
+UniformBuffer::~UniformBuffer() {
+    glDeleteBuffers(1, &ID);
+}
+
+UniformBuffer::UniformBuffer(UniformBuffer&& other) noexcept
+    : ID(std::exchange(other.ID, 0)), buffer_size(other.buffer_size),
+      binding_point(other.binding_point) {}
+
+UniformBuffer& UniformBuffer::operator=(UniformBuffer&& other) noexcept {
+    if (this != &other) {
+        glDeleteBuffers(1, &ID);
+        ID = std::exchange(other.ID, 0);
+        buffer_size = other.buffer_size;
+        binding_point = other.binding_point;
+    }
+
+    return *this;
+}
+
+void UniformBuffer::update(void const *data, std::size_t size, std::size_t offset) const {
+    glBindBuffer(GL_UNIFORM_BUFFER, ID);
+    glBufferSubData(
+        GL_UNIFORM_BUFFER,
+        static_cast<GLintptr>(offset),
+        static_cast<GLsizeiptr>(size),
+        data
+    );
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void UniformBuffer::bind() const {
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding_point, ID);
+}
@@ -0,0 +1,138 @@
+#include <upload_ring.h>
+
+#include <gl_ext.h>
+
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+
+namespace {
+
+// keeps every region aligned for any texel type and GL_UNPACK_ALIGNMENT
+constexpr std::size_t region_alignment = 64;
+
+} // namespace
+
+UploadRing::UploadRing(std::size_t size) : capacity(size) {
+    auto const flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &ID);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ID);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, capacity, NULL, flags);
+    mapped = static_cast<unsigned char *>(
+        glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, capacity, flags)
+    );
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if (mapped == NULL) {
+        std::cerr << "ERROR::UPLOAD_RING::MAP_FAILED\n";
+        capacity = 0;
+    }
+}
+
+UploadRing::~UploadRing() {
+    for (auto const& pending : fences) {
+        glDeleteSync(pending.sync);
+    }
+
+    if (mapped != NULL) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ID);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    glDeleteBuffers(1, &ID);
+}
+
+bool UploadRing::supported() {
+    return GLEXT_ARB_buffer_storage != 0;
+}
+
+bool UploadRing::allocate(std::size_t size, upload_region& region) {
+    auto const aligned =
+        (size + region_alignment - 1) / region_alignment * region_alignment;
+    auto const lock = std::lock_guard{mutex};
+
+    if (mapped == NULL || aligned == 0 || aligned > capacity) {
+        return false;
+    }
+
+    // an empty ring starts over at 0 so a region as large as the buffer fits
+    if (used == 0) {
+        head = 0;
+    }
+
+    // the free space is the span from `head` forwards to the oldest
+    // allocation, a region that doesn't fit before the end of the buffer
+    // starts over at 0 and the skipped bytes are charged to it
+    auto const padding = head + aligned > capacity ? capacity - head : 0;
+    auto const needed = padding + aligned;
+
+    if (needed > capacity - used) {
+        return false;
+    }
+
+    auto const offset = padding > 0 ? 0 : head;
+
+    head = (offset + aligned) % capacity;
+    used += needed;
+    allocations.push_back(allocation{offset, needed, false, 0});
+
+    region = upload_region{offset, mapped + offset, size};
+    return true;
+}
+
+void UploadRing::submit(upload_region const& region) {
+    auto const lock = std::lock_guard{mutex};
+
+    for (auto& entry : allocations) {
+        if (entry.offset == region.offset && !entry.submitted) {
+            entry.submitted = true;
+            return;
+        }
+    }
+}
+
+void UploadRing::fence() {
+    auto const lock = std::lock_guard{mutex};
+    auto covered = false;
+
+    for (auto& entry : allocations) {
+        if (entry.submitted && entry.fence == 0) {
+            entry.fence = next_fence;
+            covered = true;
+        }
+    }
+
+    if (covered) {
+        fences.push_back(pending_fence{
+            glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0),
+            next_fence++,
+        });
+    }
+}
+
+void UploadRing::reclaim() {
+    while (!fences.empty()) {
+        auto const sync = fences.front().sync;
+        auto const status = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+            break;
+        }
+
+        completed_fence = fences.front().index;
+        glDeleteSync(sync);
+        fences.pop_front();
+    }
+
+    auto const lock = std::lock_guard{mutex};
+
+    // regions are only recycled from the oldest one, an allocation still
+    // being written by a worker holds back everything allocated after it
+    while (!allocations.empty() && allocations.front().fence != 0
+           && allocations.front().fence <= completed_fence) {
+        used -= allocations.front().size;
+        allocations.pop_front();
+    }
+}
@@ -0,0 +1,690 @@
+#include <virtual_texture.h>
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+// texels repeated around every tile, one compressed block
+constexpr int tile_border = 4;
+
+int format_channels(unsigned int pixel_format) {
+    switch (pixel_format) {
+        case GL_RED:
+            return 1;
+        case GL_RG:
+            return 2;
+        case GL_RGB:
+            return 3;
+        default:
+            return 4;
+    }
+}
+
+int next_power_of_two(int value) {
+    int result = 1;
+
+    while (result < value) {
+        result *= 2;
+    }
+
+    return result;
+}
+
+} // namespace
+
+VirtualTexture::VirtualTexture(
+    std::filesystem::path const& path,
+    int atlas_tiles,
+    int tile_size,
+    unsigned int threads
+)
+    : container(path, file_access::random), tile(tile_size), atlas_slots(atlas_tiles),
+      slot_size(tile_size + 2 * tile_border) {
+    if (!container.ok()) {
+        return;
+    }
+
+    auto const& header = container.header();
+
+    if (tile <= 0 || tile % 4 != 0) {
+        std::cerr << "ERROR::VIRTUAL_TEXTURE::INVALID_TILE_SIZE\n" << tile << "\n";
+        return;
+    }
+
+    if (!texture_format_supported(header.internal_format)) {
+        std::cerr << "ERROR::VIRTUAL_TEXTURE::UNSUPPORTED_FORMAT\n"
+                  << path.string() << "\n";
+        return;
+    }
+
+    auto const compressed = (header.flags & CONTAINER_COMPRESSED) != 0;
+    unit_size = compressed ? 4 : 1;
+    unit_bytes = compressed ? compressed_block_size(header.internal_format)
+                            : format_channels(header.pixel_format);
+
+    // levels down to the first that fits in a single page, smaller ones are
+    // never sampled
+    for (int level = 0; level < container.levels(); ++level) {
+        auto const across = (mip_level_size(width(), level) + tile - 1) / tile;
+        auto const down = (mip_level_size(height(), level) + tile - 1) / tile;
+
+        pages_x.push_back(across);
+        pages_y.push_back(down);
+        page_slots.emplace_back(static_cast<std::size_t>(across) * down, -1);
+        page_pending.emplace_back(static_cast<std::size_t>(across) * down, 0);
+
+        if (across == 1 && down == 1) {
+            break;
+        }
+    }
+
+    // the coarsest level stays resident and needs room left for streaming
+    auto const root_pages = pages_x.back() * pages_y.back();
+
+    if (root_pages >= atlas_slots * atlas_slots) {
+        std::cerr << "ERROR::VIRTUAL_TEXTURE::ATLAS_TOO_SMALL\n"
+                  << root_pages << " pages in the coarsest level of " << path.string()
+                  << "\n";
+        return;
+    }
+
+    atlas.emplace(
+        atlas_slots * slot_size,
+        atlas_slots * slot_size,
+        header.internal_format,
+        1
+    );
+    atlas->set_sampler(
+        texture_sampler{GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE, GL_LINEAR, GL_LINEAR}
+    );
+
+    // a power-of-two chain is at least as large as the pages of every level
+    auto const table_width = next_power_of_two(pages_x[0]);
+    auto const table_height = next_power_of_two(pages_y[0]);
+
+    page_table.emplace(table_width, table_height, GL_RGBA8UI, page_levels());
+    page_table->set_sampler(texture_sampler{
+        GL_CLAMP_TO_EDGE,
+        GL_CLAMP_TO_EDGE,
+        GL_NEAREST_MIPMAP_NEAREST,
+        GL_NEAREST,
+    });
+
+    for (int level = 0; level < page_levels(); ++level) {
+        table.emplace_back(
+            static_cast<std::size_t>(mip_level_size(table_width, level))
+            * mip_level_size(table_height, level)
+        );
+    }
+
+    slots.assign(
+        static_cast<std::size_t>(atlas_slots) * atlas_slots,
+        tile_slot{virtual_page{0, 0, -1}, 0, false, 0}
+    );
+
+    int alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    auto const root = page_levels() - 1;
+
+    for (int y = 0; y < pages_y[root]; ++y) {
+        for (int x = 0; x < pages_x[root]; ++x) {
+            auto root_tile = decoded_tile{virtual_page{x, y, root}, 0, {}};
+            read_tile(root_tile.page, root_tile.texels);
+            place(root_tile);
+            slots[page_slots[root][y * pages_x[root] + x]].pinned = true;
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+
+    rebuild_table();
+    valid = true;
+
+    for (unsigned int i = 0; i < std::max(threads, 1u); ++i) {
+        workers.emplace_back([this] { run(); });
+    }
+}
+
+VirtualTexture::~VirtualTexture() {
+    {
+        auto const lock = std::lock_guard{mutex};
+        running = false;
+    }
+
+    wake.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void VirtualTexture::request(unsigned char const *feedback, std::size_t count) {
+    if (!valid) {
+        return;
+    }
+
+    {
+        auto const lock = std::lock_guard{mutex};
+
+        // the feedback is newer than anything still queued, pages that are
+        // still visible are queued again below
+        for (auto const& job : jobs) {
+            auto const& page = job.page;
+            page_pending[page.level][page.y * pages_x[page.level] + page.x] = 0;
+        }
+
+        jobs.clear();
+
+        for (auto& slot : slots) {
+            slot.weight = 0;
+        }
+
+        // index into `jobs` of every page queued below, keyed by level, y
+        // and x
+        auto queued = std::unordered_map<std::uint64_t, std::size_t>{};
+
+        for (std::size_t i = 0; i < count; ++i) {
+            auto const *texel = feedback + i * 4;
+
+            // alpha is the level plus one, 0 where nothing was drawn
+            if (texel[3] == 0) {
+                continue;
+            }
+
+            auto page = virtual_page{
+                texel[0] | (texel[2] & 0x0F) << 8,
+                texel[1] | (texel[2] >> 4) << 8,
+                texel[3] - 1,
+            };
+
+            if (page.level >= page_levels() || page.x >= pages_x[page.level]
+                || page.y >= pages_y[page.level]) {
+                continue;
+            }
+
+            // missing ancestors are queued too, so the page refines one
+            // level at a time instead of jumping from the coarsest. The
+            // texel samples the first resident page on the way up
+            while (true) {
+                auto const index = page.y * pages_x[page.level] + page.x;
+                auto const slot = page_slots[page.level][index];
+
+                if (slot >= 0) {
+                    ++slots[slot].weight;
+                    touch(page);
+                    break;
+                }
+
+                auto const key = static_cast<std::uint64_t>(page.level) << 48
+                               | static_cast<std::uint64_t>(page.y) << 24
+                               | static_cast<std::uint64_t>(page.x);
+
+                if (!page_pending[page.level][index]) {
+                    page_pending[page.level][index] = 1;
+                    queued[key] = jobs.size();
+                    jobs.push_back(tile_request{page, 1});
+                    ++counters.requests;
+                } else if (auto const job = queued.find(key); job != queued.end()) {
+                    ++jobs[job->second].weight;
+                }
+
+                if (page.level + 1 >= page_levels()) {
+                    break;
+                }
+
+                page = parent(page);
+            }
+        }
+
+        // tiles more of the screen will sample first, an ancestor always
+        // weighs at least as much as its queued descendants so the coarser
+        // one wins a tie
+        std::stable_sort(
+            jobs.begin(),
+            jobs.end(),
+            [](tile_request const& a, tile_request const& b) {
+                if (a.weight != b.weight) {
+                    return a.weight > b.weight;
+                }
+
+                return a.page.level > b.page.level;
+            }
+        );
+    }
+
+    wake.notify_all();
+}
+
+std::size_t VirtualTexture::update(int max_tiles) {
+    if (!valid) {
+        return 0;
+    }
+
+    auto ready = std::vector<decoded_tile>{};
+
+    {
+        auto const lock = std::lock_guard{mutex};
+
+        while (!finished.empty() && static_cast<int>(ready.size()) < max_tiles) {
+            ready.push_back(std::move(finished.front()));
+            finished.pop_front();
+        }
+    }
+
+    int alignment = 4;
+    glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // a tile that finds no slot is dropped and requested again by the
+    // next feedback that still needs it
+    for (auto const& current : ready) {
+        auto const& page = current.page;
+        page_pending[page.level][page.y * pages_x[page.level] + page.x] = 0;
+        place(current);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+
+    if (table_dirty) {
+        rebuild_table();
+    }
+
+    ++frame;
+
+    auto const lock = std::lock_guard{mutex};
+    return jobs.size() + in_flight + finished.size();
+}
+
+void VirtualTexture::bind(Shader const& shader, float lod_bias) const {
+    if (!valid) {
+        return;
+    }
+
+    auto const atlas_unit = shader.sampler_unit("vt_atlas");
+    auto const table_unit = shader.sampler_unit("vt_page_table");
+
+    if (atlas_unit >= 0) {
+        atlas->bind(atlas_unit);
+    }
+
+    if (table_unit >= 0) {
+        page_table->bind(table_unit);
+    }
+
+    shader.set_uniform(
+        "vt_size"_uniform,
+        static_cast<float>(width()),
+        static_cast<float>(height()),
+        static_cast<float>(tile),
+        static_cast<float>(tile_border)
+    );
+    shader.set_uniform(
+        "vt_layout"_uniform,
+        static_cast<float>(atlas_slots * slot_size),
+        static_cast<float>(page_levels()),
+        lod_bias,
+        0.0f
+    );
+}
+
+int VirtualTexture::resident_tiles() const {
+    auto const resident = std::count_if(slots.begin(), slots.end(), [](auto const& slot) {
+        return slot.page.level >= 0;
+    });
+
+    return static_cast<int>(resident);
+}
+
+void VirtualTexture::run() {
+    while (true) {
+        auto job = tile_request{};
+
+        {
+            auto lock = std::unique_lock{mutex};
+            wake.wait(lock, [this] { return !running || !jobs.empty(); });
+
+            if (!running) {
+                return;
+            }
+
+            job = jobs.front();
+            jobs.pop_front();
+            ++in_flight;
+        }
+
+        auto current = decoded_tile{job.page, job.weight, {}};
+        read_tile(job.page, current.texels);
+
+        auto const lock = std::lock_guard{mutex};
+        finished.push_back(std::move(current));
+        --in_flight;
+    }
+}
+
+void VirtualTexture::read_tile(
+    virtual_page page,
+    std::vector<unsigned char>& texels
+) const {
+    // compressed levels are copied a block at a time, so every coordinate
+    // here counts units of `unit_size` texels
+    auto const level_width = mip_level_size(width(), page.level);
+    auto const level_height = mip_level_size(height(), page.level);
+    auto const units_x = (level_width + unit_size - 1) / unit_size;
+    auto const units_y = (level_height + unit_size - 1) / unit_size;
+    auto const tile_units = slot_size / unit_size;
+    auto const first_x = (page.x * tile - tile_border) / unit_size;
+    auto const first_y = (page.y * tile - tile_border) / unit_size;
+    auto const row_bytes = static_cast<std::size_t>(units_x) * unit_bytes;
+    auto const *data = container.level_data(page.level);
+
+    texels.resize(static_cast<std::size_t>(tile_units) * tile_units * unit_bytes);
+
+    // the span inside the level is one copy, the border past its edges
+    // repeats the outermost texels or blocks
+    auto const inside_begin = std::max(first_x, 0);
+    auto const inside_end = std::min(first_x + tile_units, units_x);
+
+    for (int y = 0; y < tile_units; ++y) {
+        auto const *src = data + std::clamp(first_y + y, 0, units_y - 1) * row_bytes;
+        auto *dst = texels.data() + static_cast<std::size_t>(y) * tile_units * unit_bytes;
+
+        for (int x = 0; x < tile_units; ++x) {
+            auto const source_x = first_x + x;
+
+            if (source_x >= inside_begin && source_x < inside_end) {
+                continue;
+            }
+
+            std::memcpy(
+                dst + x * unit_bytes,
+                src + std::clamp(source_x, 0, units_x - 1) * unit_bytes,
+                unit_bytes
+            );
+        }
+
+        std::memcpy(
+            dst + (inside_begin - first_x) * unit_bytes,
+            src + inside_begin * unit_bytes,
+            static_cast<std::size_t>(inside_end - inside_begin) * unit_bytes
+        );
+    }
+}
+
+bool VirtualTexture::place(decoded_tile const& current) {
+    auto chosen = -1;
+
+    for (std::size_t i = 0; i < slots.size() && chosen < 0; ++i) {
+        if (slots[i].page.level < 0) {
+            chosen = static_cast<int>(i);
+        }
+    }
+
+    // otherwise the least recently used tile nothing sampled this frame
+    for (std::size_t i = 0; i < slots.size() && chosen < 0; ++i) {
+        auto const& slot = slots[i];
+
+        if (slot.pinned || slot.used >= frame) {
+            continue;
+        }
+
+        if (chosen < 0 || slot.used < slots[chosen].used) {
+            chosen = static_cast<int>(i);
+        }
+    }
+
+    // every slot was sampled this frame: the tile the fewest texels sample
+    // gives way to one more of them need, or as many at a finer level, so
+    // a full atlas keeps refining instead of freezing at coarse levels
+    if (chosen < 0) {
+        auto lightest = -1;
+
+        for (std::size_t i = 0; i < slots.size(); ++i) {
+            auto const& slot = slots[i];
+
+            if (slot.pinned) {
+                continue;
+            }
+
+            if (lightest < 0 || slot.weight < slots[lightest].weight
+                || (slot.weight == slots[lightest].weight
+                    && slot.page.level > slots[lightest].page.level)) {
+                lightest = static_cast<int>(i);
+            }
+        }
+
+        if (lightest >= 0) {
+            auto const& victim = slots[lightest];
+
+            if (current.weight > victim.weight
+                || (current.weight == victim.weight
+                    && current.page.level < victim.page.level)) {
+                chosen = lightest;
+            }
+        }
+    }
+
+    if (chosen < 0) {
+        return false;
+    }
+
+    auto& slot = slots[chosen];
+
+    if (slot.page.level >= 0) {
+        auto const& old = slot.page;
+        page_slots[old.level][old.y * pages_x[old.level] + old.x] = -1;
+        ++counters.evictions;
+    }
+
+    upload_tile(chosen, current.texels);
+
+    auto const& page = current.page;
+    slot = tile_slot{page, frame, false, current.weight};
+    page_slots[page.level][page.y * pages_x[page.level] + page.x] = chosen;
+    table_dirty = true;
+    ++counters.uploads;
+    return true;
+}
+
+void VirtualTexture::upload_tile(int slot, std::vector<unsigned char> const& texels) {
+    auto const x = slot % atlas_slots * slot_size;
+    auto const y = slot / atlas_slots * slot_size;
+    auto const& header = container.header();
+
+    if (header.flags & CONTAINER_COMPRESSED) {
+        atlas->upload_compressed(
+            0,
+            x,
+            y,
+            slot_size,
+            slot_size,
+            texels.size(),
+            texels.data()
+        );
+    } else {
+        atlas->upload(
+            0,
+            x,
+            y,
+            slot_size,
+            slot_size,
+            header.pixel_format,
+            header.type,
+            texels.data()
+        );
+    }
+}
+
+virtual_page VirtualTexture::parent(virtual_page page) const {
+    auto const centre_x = std::min(page.x * tile + tile / 2, width() - 1);
+    auto const centre_y = std::min(page.y * tile + tile / 2, height() - 1);
+    auto const level = page.level + 1;
+
+    return virtual_page{
+        std::min(centre_x / 2 / tile, pages_x[level] - 1),
+        std::min(centre_y / 2 / tile, pages_y[level] - 1),
+        level,
+    };
+}
+
+void VirtualTexture::touch(virtual_page page) {
+    // ancestors stand in for the page once it is evicted
+    while (true) {
+        auto const slot = page_slots[page.level][page.y * pages_x[page.level] + page.x];
+
+        if (slot >= 0) {
+            slots[slot].used = frame;
+        }
+
+        if (page.level + 1 >= page_levels()) {
+            return;
+        }
+
+        page = parent(page);
+    }
+}
+
+void VirtualTexture::rebuild_table() {
+    auto const table_width = page_table->width();
+
+    // coarsest first, a missing page inherits the entry of its parent
+    for (int level = page_levels() - 1; level >= 0; --level) {
+        auto const row = mip_level_size(table_width, level);
+
+        for (int y = 0; y < pages_y[level]; ++y) {
+            for (int x = 0; x < pages_x[level]; ++x) {
+                auto const slot = page_slots[level][y * pages_x[level] + x];
+                auto& entry = table[level][y * row + x];
+
+                if (slot >= 0) {
+                    entry = {
+                        static_cast<unsigned char>(slot % atlas_slots),
+                        static_cast<unsigned char>(slot / atlas_slots),
+                        static_cast<unsigned char>(level),
+                        255,
+                    };
+                } else if (level + 1 < page_levels()) {
+                    auto const up = parent(virtual_page{x, y, level});
+                    auto const up_row = mip_level_size(table_width, up.level);
+                    entry = table[up.level][up.y * up_row + up.x];
+                }
+            }
+        }
+
+        page_table->upload(level, GL_RGBA_INTEGER, GL_UNSIGNED_BYTE, table[level].data());
+    }
+
+    table_dirty = false;
+}
+
+VirtualTextureFeedback::VirtualTextureFeedback(int width, int height)
+    : target_width(width), target_height(height) {
+    glGenRenderbuffers(1, &colour);
+    glBindRenderbuffer(GL_RENDERBUFFER, colour);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER,
+        GL_COLOR_ATTACHMENT0,
+        GL_RENDERBUFFER,
+        colour
+    );
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "ERROR::VIRTUAL_TEXTURE::FEEDBACK_INCOMPLETE\n"
+                  << width << "x" << height << "\n";
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    auto const size = static_cast<GLsizeiptr>(width) * height * 4;
+    glGenBuffers(readback_count, buffers.data());
+
+    for (auto const buffer : buffers) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, size, NULL, GL_STREAM_READ);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+VirtualTextureFeedback::~VirtualTextureFeedback() {
+    for (auto const fence : fences) {
+        if (fence != 0) {
+            glDeleteSync(fence);
+        }
+    }
+
+    glDeleteBuffers(readback_count, buffers.data());
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &colour);
+}
+
+void VirtualTextureFeedback::begin() {
+    glGetIntegerv(GL_VIEWPORT, viewport.data());
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, target_width, target_height);
+
+    // a zero alpha marks texels nothing was drawn to
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void VirtualTextureFeedback::end() {
+    // every buffer still waiting to be resolved, this pass is skipped
+    if (fences[write_index] == 0) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers[write_index]);
+        glReadPixels(0, 0, target_width, target_height, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        fences[write_index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        write_index = (write_index + 1) % readback_count;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
+
+bool VirtualTextureFeedback::resolve(VirtualTexture& texture) {
+    auto const fence = fences[read_index];
+
+    if (fence == 0) {
+        return false;
+    }
+
+    auto const status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+        return false;
+    }
+
+    glDeleteSync(fence);
+    fences[read_index] = 0;
+
+    auto const count = static_cast<std::size_t>(target_width) * target_height;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffers[read_index]);
+    auto const *texels = static_cast<unsigned char const *>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, count * 4, GL_MAP_READ_BIT)
+    );
+
+    if (texels != nullptr) {
+        texture.request(texels, count);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    read_index = (read_index + 1) % readback_count;
+    return true;
+}
@@ -0,0 +1,253 @@
+// Offline texture baker, converts an image stb_image can decode into a
+// texture container (see texture_container.h) holding every mip level, so
+// loading it at runtime is a file mapping and a copy to the GPU.
+//
+//     learn_opengl_bake [--srgb] [--flip] [--premultiply] [--no-mips]
+//                       [--filter box|kaiser] [--compress bc1|bc3|bc7|etc2]
+//                       [--quality fast|normal|high] input output.tex
+//
+// `--srgb` stores colour data in an sRGB format and filters mips in linear
+// light, `--flip` stores the image bottom row first as OpenGL expects,
+// `--premultiply` multiplies colour by alpha before the mips are filtered,
+// `--no-mips` only stores level 0, `--filter` picks the mip filter.
+// `--compress` encodes every level into a block-compressed format, the
+// image is expanded to RGBA first, `--quality` picks the encoder effort.
+// Returns non-zero if the input can't be decoded or the output written.
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "stb_image.h"
+
+#include <block_compression.h>
+#include <image_ops.h>
+#include <mapped_file.h>
+#include <mipmap.h>
+#include <texture_container.h>
+
+namespace {
+
+unsigned int pixel_format(int channels) {
+    switch (channels) {
+        case 1:
+            return GL_RED;
+        case 2:
+            return GL_RG;
+        case 3:
+            return GL_RGB;
+        default:
+            return GL_RGBA;
+    }
+}
+
+// sRGB only exists for three and four channel formats
+unsigned int internal_format(int channels, bool srgb) {
+    switch (channels) {
+        case 1:
+            return GL_R8;
+        case 2:
+            return GL_RG8;
+        case 3:
+            return srgb ? GL_SRGB8 : GL_RGB8;
+        default:
+            return srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+    }
+}
+
+std::optional<block_format> parse_block_format(std::string_view name) {
+    if (name == "bc1") {
+        return block_format::bc1;
+    } else if (name == "bc3") {
+        return block_format::bc3;
+    } else if (name == "bc7") {
+        return block_format::bc7;
+    } else if (name == "etc2") {
+        return block_format::etc2_rgb;
+    }
+
+    return std::nullopt;
+}
+
+std::optional<mip_filter> parse_filter(std::string_view name) {
+    if (name == "box") {
+        return mip_filter::box;
+    } else if (name == "kaiser") {
+        return mip_filter::kaiser;
+    }
+
+    return std::nullopt;
+}
+
+std::optional<compression_quality> parse_quality(std::string_view name) {
+    if (name == "fast") {
+        return compression_quality::fast;
+    } else if (name == "normal") {
+        return compression_quality::normal;
+    } else if (name == "high") {
+        return compression_quality::high;
+    }
+
+    return std::nullopt;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    auto srgb = false;
+    auto transform = image_options{};
+    auto mips = true;
+    auto filter = std::optional<mip_filter>{mip_filter::box};
+    auto compress = std::optional<block_format>{};
+    auto quality = std::optional<compression_quality>{compression_quality::normal};
+    auto files = std::vector<char const *>{};
+
+    for (int i = 1; i < argc; ++i) {
+        auto const arg = std::string_view{argv[i]};
+        auto const takes_value =
+            arg == "--filter" || arg == "--compress" || arg == "--quality";
+
+        if (takes_value && i + 1 == argc) {
+            std::cerr << "missing value for " << arg << "\n";
+            return 1;
+        }
+
+        if (arg == "--srgb") {
+            srgb = true;
+        } else if (arg == "--flip") {
+            transform.flip = true;
+        } else if (arg == "--premultiply") {
+            transform.premultiply = true;
+        } else if (arg == "--no-mips") {
+            mips = false;
+        } else if (arg == "--filter") {
+            filter = parse_filter(argv[++i]);
+
+            if (!filter) {
+                std::cerr << "Unknown mip filter " << argv[i] << "\n";
+                return 1;
+            }
+        } else if (arg == "--compress") {
+            compress = parse_block_format(argv[++i]);
+
+            if (!compress) {
+                std::cerr << "Unknown block format " << argv[i] << "\n";
+                return 1;
+            }
+        } else if (arg == "--quality") {
+            quality = parse_quality(argv[++i]);
+
+            if (!quality) {
+                std::cerr << "Unknown quality " << argv[i] << "\n";
+                return 1;
+            }
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    if (files.size() != 2) {
+        std::cerr << "usage: learn_opengl_bake [--srgb] [--flip] [--premultiply] "
+                     "[--no-mips] [--filter box|kaiser] "
+                     "[--compress bc1|bc3|bc7|etc2] [--quality fast|normal|high] "
+                     "input output"
+                  << texture_container_extension << "\n";
+        return 1;
+    }
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+
+    auto const input = MappedFile(files[0], file_access::sequential);
+
+    if (!input.ok()) {
+        std::cerr << "Failed to read " << files[0] << "\n";
+        return 1;
+    }
+
+    // stb_image takes the length as an int
+    if (input.size() > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        std::cerr << "Input too large " << files[0] << "\n";
+        return 1;
+    }
+
+    // the encoders read RGBA whatever the source has
+    unsigned char *pixels = stbi_load_from_memory(
+        input.data(),
+        static_cast<int>(input.size()),
+        &width,
+        &height,
+        &channels,
+        compress ? 4 : 0
+    );
+
+    if (pixels == NULL) {
+        std::cerr << "Failed to decode " << files[0] << ": " << stbi_failure_reason()
+                  << "\n";
+        return 1;
+    }
+
+    if (compress) {
+        channels = 4;
+    }
+
+    auto const bytes = static_cast<std::size_t>(width) * height * channels;
+    auto levels = std::vector<std::vector<unsigned char>>{};
+    levels.emplace_back(pixels, pixels + bytes);
+    stbi_image_free(pixels);
+
+    transform_image(levels[0].data(), width, height, channels, transform);
+
+    if (mips) {
+        auto const options = mip_options{*filter, srgb, 0};
+        auto chain = build_mip_chain(levels[0].data(), width, height, channels, options);
+
+        for (auto& level : chain) {
+            levels.push_back(std::move(level.pixels));
+        }
+    }
+
+    if (compress) {
+        for (std::size_t level = 0; level < levels.size(); ++level) {
+            levels[level] = compress_image(
+                levels[level].data(),
+                mip_level_size(width, static_cast<int>(level)),
+                mip_level_size(height, static_cast<int>(level)),
+                *compress,
+                *quality
+            );
+        }
+    }
+
+    auto header = container_header{};
+    header.width = static_cast<std::uint32_t>(width);
+    header.height = static_cast<std::uint32_t>(height);
+    header.internal_format = internal_format(channels, srgb);
+    header.pixel_format = pixel_format(channels);
+    header.type = GL_UNSIGNED_BYTE;
+    header.flags = srgb && channels >= 3 ? std::uint32_t{CONTAINER_SRGB} : 0u;
+
+    // compressed levels have no client format, the blocks are copied as is
+    if (compress) {
+        header.internal_format = compressed_internal_format(*compress, srgb);
+        header.pixel_format = 0;
+        header.type = 0;
+        header.flags |= CONTAINER_COMPRESSED;
+    }
+
+    if (!write_texture_container(files[1], header, levels)) {
+        return 1;
+    }
+
+    std::cout << files[0] << " -> " << files[1] << " (" << width << "x" << height << ", "
+              << levels.size() << " levels)\n";
+    return 0;
+}
@@ -0,0 +1,263 @@
+// Offline shader compiler that warms the program binary cache so the first
+// launch of `learn_opengl` does not pay for compiling its shaders.
+//
+//     learn_opengl_shaderc [--shaders dir] [--out dir] [--variant defines]...
+//
+// Every `name.vert` under `--shaders` (default `shaders`) with a matching
+// `name.frag` is a program. Each program is built once without defines and
+// once per `--variant`, given in `permutation_key` form, eg. `WIREFRAME` or
+// `SHADOWS=2;WIREFRAME`. Programs are compiled and linked through `Shader`
+// in a headless EGL context, so the binaries and their keys are exactly what
+// the application would produce, and are written to `--out` (default
+// `shader_cache`) together with a `manifest.txt` listing each entry.
+//
+// Binaries are only usable by the driver that produced them, run the tool on
+// the target machine, eg. at install time. Variants defining BINDLESS are
+// skipped on drivers without ARB_bindless_texture. Returns non-zero if any
+// program failed to build.
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+// clang-format off
+#include <glad/glad.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+// clang-format on
+
+#include <gl_ext.h>
+#include <program_cache.h>
+#include <shader.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct program_sources {
+    fs::path vertex;
+    fs::path fragment;
+};
+
+// parse `permutation_key` syntax, eg. "SHADOWS=2;WIREFRAME"
+shader_defines parse_variant(std::string_view variant) {
+    auto defines = shader_defines{};
+
+    while (!variant.empty()) {
+        auto const end = std::min(variant.find(';'), variant.size());
+        auto const entry = variant.substr(0, end);
+        auto const equals = std::min(entry.find('='), entry.size());
+
+        if (!entry.empty()) {
+            defines.push_back({
+                std::string(entry.substr(0, equals)),
+                std::string(entry.substr(std::min(equals + 1, entry.size()))),
+            });
+        }
+
+        variant.remove_prefix(std::min(end + 1, variant.size()));
+    }
+
+    return defines;
+}
+
+std::vector<program_sources> find_programs(fs::path const& directory) {
+    auto programs = std::vector<program_sources>{};
+
+    for (auto const& entry : fs::recursive_directory_iterator(directory)) {
+        if (!entry.is_regular_file() || entry.path().extension() != ".vert") {
+            continue;
+        }
+
+        auto fragment = entry.path();
+        fragment.replace_extension(".frag");
+
+        if (fs::exists(fragment)) {
+            programs.push_back({entry.path(), fragment});
+        }
+    }
+
+    // directory order is unspecified, keep the manifest stable
+    std::sort(programs.begin(), programs.end(), [](auto const& a, auto const& b) {
+        return a.vertex < b.vertex;
+    });
+
+    return programs;
+}
+
+// make a core 3.3 context current without a window or surface, returns
+// false if EGL or the driver can't provide one
+bool create_headless_context(EGLDisplay& display) {
+    auto const get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+        eglGetProcAddress("eglGetPlatformDisplayEXT")
+    );
+
+    display = EGL_NO_DISPLAY;
+
+    if (get_platform_display != NULL) {
+        display = get_platform_display(
+            EGL_PLATFORM_SURFACELESS_MESA,
+            EGL_DEFAULT_DISPLAY,
+            NULL
+        );
+    }
+
+    if (display == EGL_NO_DISPLAY) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    }
+
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) {
+        std::cerr << "Failed to initialize EGL.\n";
+        return false;
+    }
+
+    // the surface type defaults to EGL_WINDOW_BIT, which no config of the
+    // surfaceless platform has
+    EGLint const config_attribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE,
+    };
+    EGLConfig config;
+    EGLint configs = 0;
+
+    if (!eglBindAPI(EGL_OPENGL_API)
+        || !eglChooseConfig(display, config_attribs, &config, 1, &configs)
+        || configs == 0) {
+        std::cerr << "Failed to find an EGL config for desktop OpenGL.\n";
+        return false;
+    }
+
+    // same version and profile as the application so driver strings and
+    // therefore cache keys match
+    EGLint const context_attribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE,
+    };
+
+    auto const context =
+        eglCreateContext(display, config, EGL_NO_CONTEXT, context_attribs);
+
+    if (context == EGL_NO_CONTEXT
+        || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::cerr << "Failed to create a surfaceless OpenGL 3.3 context.\n";
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    auto shader_dir = fs::path("shaders");
+    auto out_dir = fs::path("shader_cache");
+    auto variants = std::vector<std::string>{""};
+
+    for (int i = 1; i < argc; i += 2) {
+        auto const option = std::string_view{argv[i]};
+        auto const known =
+            option == "--shaders" || option == "--out" || option == "--variant";
+
+        if (known && i + 1 == argc) {
+            std::cerr << "missing value for " << option << "\n";
+            return 1;
+        }
+
+        if (option == "--shaders") {
+            shader_dir = argv[i + 1];
+        } else if (option == "--out") {
+            out_dir = argv[i + 1];
+        } else if (option == "--variant") {
+            variants.push_back(permutation_key(parse_variant(argv[i + 1])));
+        } else {
+            std::cerr << "unknown option " << option << "\n";
+            return 1;
+        }
+    }
+
+    auto display = EGLDisplay{EGL_NO_DISPLAY};
+
+    if (!create_headless_context(display)) {
+        return 1;
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD.\n";
+        return 1;
+    }
+
+    load_gl_extensions((GLADloadproc)eglGetProcAddress);
+
+    if (!GLEXT_ARB_get_program_binary) {
+        std::cerr << "The driver does not support program binaries.\n";
+        return 1;
+    }
+
+    auto error = std::error_code{};
+    fs::create_directories(out_dir, error);
+    program_cache::set_directory(out_dir);
+
+    auto manifest = std::ofstream(out_dir / "manifest.txt");
+    manifest << "# " << glGetString(GL_VENDOR) << " | " << glGetString(GL_RENDERER)
+             << " | " << glGetString(GL_VERSION) << "\n";
+
+    auto failed = 0;
+
+    for (auto const& program : find_programs(shader_dir)) {
+        for (auto const& variant : variants) {
+            auto const defines = parse_variant(variant);
+            auto const bindless =
+                std::any_of(defines.begin(), defines.end(), [](auto const& define) {
+                    return define.name == "BINDLESS";
+                });
+
+            // the application falls back to texture arrays on these drivers,
+            // so the variant is never built there
+            if (bindless && !GLEXT_ARB_bindless_texture) {
+                std::cout << "skipped " << program.vertex.generic_string() << " + "
+                          << program.fragment.generic_string() << " [" << variant
+                          << "], no ARB_bindless_texture\n";
+                continue;
+            }
+
+            // built exactly as the application builds it, `Shader` stores
+            // the binary in the cache once the program links
+            auto shader = Shader(
+                program.vertex.generic_string(),
+                program.fragment.generic_string(),
+                defines
+            );
+            auto const ok = shader.finish();
+
+            char key[32] = {0};
+            std::snprintf(
+                key,
+                sizeof(key),
+                "%016llx",
+                static_cast<unsigned long long>(shader.program_key())
+            );
+
+            manifest << key << " " << program.vertex.generic_string() << " "
+                     << program.fragment.generic_string() << " "
+                     << (variant.empty() ? "-" : variant) << " " << (ok ? "ok" : "failed")
+                     << "\n";
+            std::cout << (ok ? "ok      " : "FAILED  ") << program.vertex.generic_string()
+                      << " + " << program.fragment.generic_string()
+                      << (variant.empty() ? "" : " [" + variant + "]") << "\n";
+
+            failed += ok ? 0 : 1;
+        }
+    }
+
+    eglTerminate(display);
+    return failed == 0 ? 0 : 1;
+}